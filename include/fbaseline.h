@@ -0,0 +1,83 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Known diagnostics baseline. A diagnostic is known by the fingerprint of
+ * its path, its flag and its template, the line numbers are left out so
+ * it stays known while the code around it is edited. The fingerprints of
+ * a baseline file go into a hash set, checking a diagnostic is O(1).
+ *
+ * The file has a fingerprint a line in hex, what follows it on the line
+ * is only there to be read by people:
+ *
+ *   8f3a0c2e9d17b465 src/net/http.c -Wunused-variable unused variable '*'
+ *
+ * Only warnings go into a baseline, an error is never known whatever its
+ * fingerprint. Notes go with the warning before them, a known one takes
+ * its notes along. Known rows are kept with FINFO_KNOWN, the "!known"
+ * filter term hides them.
+ */
+
+#ifndef FBASELINE_H
+#define FBASELINE_H
+
+#include "fstore.h"
+#include "xhset.h"
+
+typedef struct
+{
+  xhset_t keys;
+  int known;                          /* the last warning is */
+  unsigned int hits[INFO_TYPE_MAX];   /* known diagnostics seen */
+}fbaseline_t;
+
+fbaseline_t *fbaseline_create(void);
+void fbaseline_destroy(fbaseline_t *base);
+
+/* count anew, the fingerprints stay. call it with fstore_flush() */
+void fbaseline_flush(fbaseline_t *base);
+
+/* add the fingerprints of the file at path, return their count or -1 */
+int fbaseline_load(fbaseline_t *base, const char *path);
+
+/* the fingerprint of info */
+unsigned long long fbaseline_key(fstore_t *store, const finfo_t *info);
+
+/* 
+ * the baseline line of info into buf, return its length. *key is set to
+ * the fingerprint
+ */
+int fbaseline_line(fstore_t *store, const finfo_t *info, char *buf, 
+                   int size, unsigned long long *key);
+
+/* 
+ * return 1 and count it if info is a known warning or a note of one,
+ * errors are never known
+ */
+int fbaseline_match(fbaseline_t *base, fstore_t *store, const finfo_t *info);
+
+static inline unsigned int fbaseline_hits(fbaseline_t *base)
+{
+  return base->hits[INFO_TYPE_ERROR] + base->hits[INFO_TYPE_WARN] 
+         + base->hits[INFO_TYPE_NOTE];
+}
+
+#endif /* FBASELINE_H */
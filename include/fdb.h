@@ -0,0 +1,110 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Persistent diagnostic database. The file is a versioned header followed
+ * by append-only segments, each one carries its length and crc so a torn
+ * tail left by a killed build is detected and cut at the next open.
+ *
+ * Loading reads the file in one piece and hands the rows to the store in
+ * place, the descriptions are used straight from that buffer without any
+ * copy. It is read rather than mapped, a file truncated behind our back
+ * can't raise SIGBUS then. Evictions are not saved as they happen, the
+ * file is written again with the live rows only once it is loaded.
+ *
+ * The file is never followed through a symlink, and one which does not
+ * start with an fdb header is left alone rather than started over.
+ */
+
+#ifndef FDB_H
+#define FDB_H
+
+#include <limits.h>
+#include <sys/types.h>
+
+#include "fstore.h"
+
+#define FDB_MAGIC     0x42444846 /* "FHDB" */
+#define FDB_SEG_MAGIC 0x47455346 /* "FSEG" */
+#define FDB_VERSION   1
+
+typedef struct
+{
+  unsigned int magic;
+  unsigned int version;
+  unsigned long long generation; /* bumped on every flush */
+}fdb_header_t;
+
+typedef struct
+{
+  unsigned int magic;
+  unsigned int count;            /* records in the segment */
+  unsigned int len;              /* payload bytes */
+  unsigned int crc;              /* crc32 of the payload */
+  unsigned long long generation;
+}fdb_segment_t;
+
+/* followed by path\0 flag\0 desc\0, the record is padded to 4 bytes */
+typedef struct
+{
+  unsigned int line;
+  unsigned int offset;
+  unsigned short path_len;
+  unsigned short flag_len;
+  unsigned int desc_len;
+  unsigned char type;
+  unsigned char pad[3];
+}fdb_record_t;
+
+typedef struct
+{
+  int fd;
+  char path[PATH_MAX];
+  unsigned long long generation;
+  off_t end;                     /* where the next segment goes */
+
+  char *map;                     /* rows loaded at open point in here */
+  size_t map_size;
+}fdb_t;
+
+/* 
+ * open or create the file at path and lock it, NULL if it can't be, is a
+ * symlink, is not an fdb file or is locked by another process
+ */
+fdb_t *fdb_open(const char *path);
+void fdb_close(fdb_t *db);
+
+/* insert all the saved rows into store, return the count or -1 */
+int fdb_load(fdb_t *db, fstore_t *store);
+
+/* save rows [from, to) of store as one segment */
+int fdb_append(fdb_t *db, fstore_t *store, unsigned int from, unsigned int to);
+
+/* drop all the saved rows, flush the store before calling it */
+int fdb_reset(fdb_t *db);
+
+/* 
+ * write the file again with the live rows of store as one segment, the
+ * rows loaded before stay valid
+ */
+int fdb_compact(fdb_t *db, fstore_t *store);
+
+#endif /* FDB_H */
@@ -0,0 +1,80 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Headless output: each parsed diagnostic is written out once, in a fixed
+ * form, as soon as it comes. The same diagnostic seen again (a header
+ * compiled by several units) is dropped by its fingerprint.
+ *
+ *   plain     path:line:column: severity: message [-Wflag]
+ *   quickfix  path:line:column:E:message, :set efm=%f:%l:%c:%t:%m in vim
+ *   jsonl     {"file":..,"line":..,"column":..,"severity":..,"flag":..,
+ *              "message":..} a line
+ *   baseline  the fbaseline file of the errors and warnings, each one once
+ *
+ * The diagnostics known by a baseline are left out.
+ */
+
+#ifndef FEMIT_H
+#define FEMIT_H
+
+#include "fstore.h"
+#include "xwriter.h"
+#include "xhset.h"
+#include "fbaseline.h"
+
+typedef enum
+{
+  FEMIT_PLAIN,
+  FEMIT_QUICKFIX,
+  FEMIT_JSONL,
+  FEMIT_BASELINE,
+
+  FEMIT_MAX,
+}femit_format_t;
+
+typedef struct
+{
+  femit_format_t format;
+  fstore_t *store;        /* the paths and flags of the rows */
+  xwriter_t out;
+  xhset_t seen;           /* fingerprints written out */
+  fbaseline_t *known;     /* rows it knows are not written, may be NULL */
+
+  unsigned long rows;
+  unsigned long dups;
+}femit_t;
+
+/* FEMIT_MAX if name is no format */
+femit_format_t femit_format_get(const char *name);
+
+femit_t *femit_create(femit_format_t format, fstore_t *store, int fd);
+
+/* the buffered output goes out first */
+void femit_destroy(femit_t *emit);
+
+/* return 1 if info is written, 0 if it was a duplicate or known, -1 on error */
+int femit_row(femit_t *emit, const finfo_t *info);
+
+/* write what is buffered, before waiting for more input */
+int femit_flush(femit_t *emit);
+
+#endif /* FEMIT_H */
@@ -0,0 +1,112 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Filter views. A term picks rows by one attribute: a severity, a flag
+ * glob like -Wunused-*, a directory or a template, it either keeps only
+ * its rows or hides them. Terms of one kind which keep rows add up, the
+ * kinds narrow each other: "error src/net/ !third_party/".
+ *
+ * Every term has a bitset of its rows over the row ids. It is built once
+ * from the row attributes, a path or a flag string is matched once for
+ * all its rows, and then kept up to date as rows come. Toggling a term
+ * is a few word-wide bitset operations and one walk of the sort index
+ * which gathers the rows shown into a subset index, no string is looked
+ * at again. A term toggled off keeps its bitset for the next time.
+ */
+
+#ifndef FFILTER_H
+#define FFILTER_H
+
+#include "fstore.h"
+#include "xbitset.h"
+
+#define FFILTER_MAX_TERMS 16
+
+typedef enum
+{
+  FFILTER_SEVERITY,
+  FFILTER_FLAG,
+  FFILTER_DIR,
+  FFILTER_TEMPLATE,
+  FFILTER_KNOWN,
+
+  FFILTER_KINDS,
+}ffilter_kind_t;
+
+typedef struct
+{
+  ffilter_kind_t kind;
+  int hide;              /* hide the rows, or keep only them */
+  int on;
+  char *pattern;         /* severity name, flag glob, directory or template */
+  unsigned int value;    /* the severity or the template id */
+
+  xbitset_t rows;        /* rows with the attribute, dead ones may stay */
+  signed char *cache;    /* flag or path id matches: 1, 0 or -1 unknown */
+  unsigned int cache_size;
+}ffilter_term_t;
+
+typedef struct
+{
+  fstore_t *store;
+  xskiplist_t *subset;   /* the rows shown, in a sort order */
+
+  ffilter_term_t terms[FFILTER_MAX_TERMS];
+  int count;
+  unsigned int next;     /* rows from here are not in the bitsets yet */
+
+  xbitset_t bits;        /* scratch for the evaluation */
+  xbitset_t any;
+  unsigned int *ids;
+  unsigned int ids_size;
+}ffilter_t;
+
+ffilter_t *ffilter_create(fstore_t *store, fsort_t sort);
+void ffilter_destroy(ffilter_t *filter);
+
+/* 
+ * toggle term, "!term" hides rows. tmpl_id is the template of "~". 
+ * return 1 if it is on now, 0 if off, -1 if the term is bad
+ */
+int ffilter_toggle(ffilter_t *filter, const char *term, unsigned int tmpl_id);
+
+/* turn every term off */
+void ffilter_clear(ffilter_t *filter);
+
+/* some term is on */
+int ffilter_active(ffilter_t *filter);
+
+/* 
+ * gather the rows the terms let through into the subset, only those of 
+ * within if it is given, within must be in the order of the subset
+ */
+int ffilter_apply(ffilter_t *filter, xskiplist_t *within);
+
+/* take the rows added since in, the shown ones go to the subset too */
+void ffilter_update(ffilter_t *filter, xskiplist_t *within);
+
+/* the terms which are on, like they are typed */
+int ffilter_describe(ffilter_t *filter, char *buf, int size);
+
+size_t ffilter_bytes(ffilter_t *filter);
+
+#endif /* FFILTER_H */
@@ -0,0 +1,79 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Wrapped layout cache: the line breaks of a row description at a given
+ * width are computed once and kept by row id. Rendering a wrapped row is
+ * then slicing the description, a width change recomputes them lazily.
+ */
+
+#ifndef FLAYOUT_H
+#define FLAYOUT_H
+
+#include <stddef.h>
+
+typedef struct
+{
+  unsigned int *breaks;    /* where the 2nd, 3rd... lines start */
+  unsigned short count;    /* breaks, the row takes count + 1 lines */
+  unsigned short size;     /* room in breaks */
+  unsigned short width;    /* the breaks are for it, 0 for none yet */
+  unsigned char cut;       /* too many lines, breaks[count] ends the last */
+}flayout_row_t;
+
+typedef struct
+{
+  flayout_row_t *rows;     /* indexed by row id */
+  unsigned int size;
+  size_t bytes;
+}flayout_t;
+
+flayout_t *flayout_create(void);
+void flayout_destroy(flayout_t *layout);
+
+/* forget all rows, call it when the row ids restart */
+void flayout_flush(flayout_t *layout);
+
+/* 
+ * the layout of row id with description desc wrapped at width columns, past
+ * FLAYOUT_LINES lines the rest is cut and the row marked cut
+ */
+#define FLAYOUT_LINES 256
+const flayout_row_t *flayout_get(flayout_t *layout, unsigned int id,
+                                 const char *desc, int width);
+
+/* 
+ * the bytes of line n (0 based) of a laid out row, *start is set to its 
+ * offset in desc, trailing spaces are not counted. the last line of a cut
+ * row stops where the cut is
+ */
+int flayout_line(const flayout_row_t *row, const char *desc, int n, 
+                 unsigned int *start);
+
+/* non zero to keep the layout of id, see flayout_prune() */
+typedef int (*flayout_keep_f)(void *ctx, unsigned int id);
+
+/* give back the breaks of the rows keep drops, evicted ones, O(n) */
+void flayout_prune(flayout_t *layout, flayout_keep_f keep, void *ctx);
+
+size_t flayout_bytes(flayout_t *layout);
+
+#endif /* FLAYOUT_H */
@@ -0,0 +1,102 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Note flood control. A bad template instantiation can follow one error
+ * with tens of thousands of notes, only the first budget notes after an
+ * error or a warning, its root, become rows. The others are counted and
+ * their lines appended to a spool file; the root gets one placeholder row
+ * standing for them which remembers their byte range in the spool. The
+ * spool is a temporary file of its own under $TMPDIR, unlinked as soon as
+ * it is open, so no other process or fhelper can get at it.
+ *
+ * Expanding a placeholder reads its range back and inserts the notes as
+ * usual rows, so nothing is lost while the memory and the rows to draw
+ * stay bounded by the budget.
+ */
+
+#ifndef FNOTES_H
+#define FNOTES_H
+
+#include "fstore.h"
+#include "xwriter.h"
+
+#define FNOTES_BUDGET 32
+#define FNOTES_DESC   "more notes, x shows them"
+
+typedef struct
+{
+  unsigned int root;             /* the error or warning, or FSTORE_NONE */
+  unsigned int row;              /* the placeholder row */
+  unsigned int count;            /* notes in the spool, 0 once expanded */
+  unsigned long long start;      /* their bytes in the spool */
+  unsigned long long end;
+}fnotes_group_t;
+
+typedef struct
+{
+  fstore_t *store;
+  unsigned int budget;           /* notes kept under a root, 0 for all */
+
+  unsigned int root;             /* the last error or warning */
+  unsigned int kept;             /* notes which became rows under it */
+  unsigned int open;             /* the group of root, FSTORE_NONE if none */
+
+  fnotes_group_t *groups;        /* in placeholder row order */
+  unsigned int count;
+  unsigned int size;
+  unsigned long long hidden;     /* notes in the spool, all groups */
+
+  int fd;
+  unsigned long long end;        /* spool bytes, the buffered ones too */
+  xwriter_t spool;
+}fnotes_t;
+
+fnotes_t *fnotes_create(fstore_t *store, unsigned int budget);
+void fnotes_destroy(fnotes_t *notes);
+
+/* forget the groups and empty the spool, call it with fstore_flush() */
+void fnotes_flush(fnotes_t *notes);
+
+/* 
+ * drop the groups whose placeholder was evicted, their notes with them.
+ * call it after fstore_trim()
+ */
+void fnotes_prune(fnotes_t *notes);
+
+/* 
+ * fstore_insert() with the budget, info is parsed from line. return the 
+ * row id, FSTORE_NONE if line went to the spool
+ */
+unsigned int fnotes_add(fnotes_t *notes, const char *line, 
+                        const finfo_t *info);
+
+/* notes behind placeholder row id, 0 if it is none */
+unsigned int fnotes_hidden(fnotes_t *notes, unsigned int id);
+
+/* 
+ * insert the notes of placeholder row id and evict it, they take its place
+ * in the arrival orders. return the id of the first inserted row,
+ * FSTORE_NONE if there is nothing to expand
+ */
+unsigned int fnotes_expand(fnotes_t *notes, unsigned int id);
+
+#endif /* FNOTES_H */
@@ -0,0 +1,87 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Local classification rules. A rule is an action and the fields it looks
+ * at, every field given must match:
+ *
+ *   # anything under vendor/ is a note
+ *   note     path:vendor/
+ *   ignore   path:tests/ flag:-Wdeprecated*
+ *   error    message:"ODR violation"
+ *
+ * Actions are error, warning, note (or info) and ignore. A path ending in
+ * '/' is a directory, matched at the start of the path or after a '/', a
+ * message with no wildcard is matched anywhere in the description, the
+ * rest are globs of '*' and '?' over the whole field.
+ *
+ * All the rules are one DFA over "path \1 flag \1 description", so a row
+ * is classified in one pass whatever the number of rules. The first rule
+ * which matches wins, with none the severity gcc gave stays.
+ */
+
+#ifndef FRULES_H
+#define FRULES_H
+
+#include "fstore.h"
+#include "xdfa.h"
+
+#define FRULES_MAX XDFA_MAX_GLOBS
+#define FRULES_SEP '\001'
+
+typedef enum
+{
+  FRULE_ERROR   = INFO_TYPE_ERROR,
+  FRULE_WARN    = INFO_TYPE_WARN,
+  FRULE_NOTE    = INFO_TYPE_NOTE,
+  FRULE_IGNORE  = INFO_TYPE_MAX,
+  FRULE_NONE,
+}frule_action_t;
+
+typedef struct
+{
+  xdfa_t *dfa;
+  unsigned char actions[FRULES_MAX];
+  int count;
+
+  int ignoring;            /* the last error or warning is ignored */
+  unsigned long ignored;
+  unsigned long changed;   /* rows given another severity */
+}frules_t;
+
+/* NULL if the file can't be read or a rule is bad, the line is told */
+frules_t *frules_load(const char *path);
+void frules_destroy(frules_t *rules);
+
+/* memory held by the rules, their dfa grows as states are built */
+size_t frules_bytes(frules_t *rules);
+
+/* the action of the first rule info matches, FRULE_NONE if none */
+frule_action_t frules_match(frules_t *rules, fstore_t *store, 
+                            const finfo_t *info);
+
+/* 
+ * apply the rules to info: its type may change. return -1 if it is to be
+ * ignored, the notes of an ignored one are ignored with it
+ */
+int frules_apply(frules_t *rules, fstore_t *store, finfo_t *info);
+
+#endif /* FRULES_H */
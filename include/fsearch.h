@@ -0,0 +1,81 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Incremental search over the descriptions. A new query only checks the
+ * rows of the shortest trigram posting list it has, a query which grows
+ * the last one only checks the last matches, so a keystroke costs about
+ * the matches and not the rows.
+ *
+ * The matches are kept in a subset index of the store in the view's
+ * order, rows coming later are checked as they come. The search is case
+ * insensitive unless the query has an upper case letter.
+ *
+ * A query shorter than a trigram would check every row, it matches
+ * nothing till it is FSEARCH_MIN long.
+ */
+
+#ifndef FSEARCH_H
+#define FSEARCH_H
+
+#include "fstore.h"
+
+#define FSEARCH_MAX 128
+#define FSEARCH_MIN 3
+
+typedef struct
+{
+  fstore_t *store;
+  xskiplist_t *subset;     /* the matches in a sort order */
+
+  char query[FSEARCH_MAX];
+  int len;
+  int icase;
+
+  unsigned int *ids;       /* the matches by id, evicted ones may stay */
+  unsigned int count;
+  unsigned int size;
+  unsigned int next;       /* rows from here are not checked yet */
+
+  unsigned long checked;   /* rows the last query checked */
+}fsearch_t;
+
+fsearch_t *fsearch_create(fstore_t *store, fsort_t sort);
+void fsearch_destroy(fsearch_t *search);
+
+/* search query, return the match count */
+long fsearch_set(fsearch_t *search, const char *query, int len);
+
+/* check the rows added since the last call, return the new matches */
+unsigned int fsearch_update(fsearch_t *search);
+
+static inline unsigned int fsearch_count(fsearch_t *search)
+{
+  return xskiplist_count(search->subset);
+}
+
+/* the query is long enough to search */
+static inline int fsearch_active(fsearch_t *search)
+{
+  return search->len >= FSEARCH_MIN;
+}
+
+#endif /* FSEARCH_H */
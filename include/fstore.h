@@ -0,0 +1,249 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Diagnostic store: every parsed gcc line becomes a row with a 32-bit id,
+ * texts live in an arena, paths and flags are interned. Each sort order is
+ * a skip list over row ids which is kept up to date on insert, so there is
+ * never a full re-sort.
+ *
+ * A subset index holds some of the rows in one of the sort orders, its
+ * owner decides which. The store keeps it weighed like the full indexes
+ * and drops evicted rows from it. All the navigation works on either.
+ *
+ * The descriptions are also in a trigram index, so a search only checks
+ * the rows which can contain the searched text. Each one has a template
+ * too, the description with its quoted names and numbers blanked, so
+ * "unused variable 'a'" and "unused variable 'b'" are one kind of row.
+ *
+ * The paths are counted in a directory tree as well, per severity.
+ */
+
+#ifndef FSTORE_H
+#define FSTORE_H
+
+#include "xintern.h"
+#include "xarena.h"
+#include "xskiplist.h"
+#include "xtrigram.h"
+#include "xbitset.h"
+#include "ftree.h"
+
+#define FSTORE_NONE ((unsigned int)-1)
+#define FSTORE_MAX_SUBSETS 4
+#define FSTORE_TEMPLATE_SIZE 256
+
+/* weights summed by every index */
+#define FSTORE_SUM_ERRORS 0
+#define FSTORE_SUM_LINES  1  /* screen lines of the rows */
+
+/* finfo_t flags */
+#define FINFO_ARENA 0x01  /* desc lives in the text arena */
+#define FINFO_DEAD  0x02  /* evicted, the id is never reused */
+#define FINFO_VOLATILE 0x04  /* lives for the session, fdb skips it */
+#define FINFO_KNOWN 0x08  /* in the baseline, the only flag inserted rows keep */
+
+typedef enum
+{
+  INFO_TYPE_ERROR,
+  INFO_TYPE_WARN,
+  INFO_TYPE_NOTE,
+
+  INFO_TYPE_UNKNOWN,
+  INFO_TYPE_MAX,
+}info_type_t;
+
+/* one parsed gcc diagnostic */
+typedef struct
+{
+  const char *desc;
+  unsigned int path_id;
+  unsigned int flag_id;   /* [-Wxxx] or XINTERN_NONE */
+  unsigned int tmpl_id;   /* set by fstore_insert() */
+  unsigned int seq;       /* arrival, the id unless put after another row */
+  unsigned int line;
+  unsigned int offset;
+  unsigned char type;
+  unsigned char flags;
+}finfo_t;
+
+typedef enum
+{
+  FSORT_DEFAULT,  /* errors first, then the others by arrival */
+  FSORT_FILE,     /* file, line, offset */
+  FSORT_SEVERITY, /* error, warning, note, by arrival */
+  FSORT_FLAG,     /* -Wxxx, then by file */
+
+  FSORT_MAX,
+}fsort_t;
+
+struct fstore;
+
+/* screen lines row id takes, see fstore_set_height() */
+typedef unsigned int (*fstore_height_f)(void *ctx, struct fstore *store, 
+                                        unsigned int id);
+
+typedef struct fstore
+{
+  finfo_t *rows;          /* indexed by row id */
+  unsigned int count;
+  unsigned int size;
+
+  unsigned int live;      /* rows not evicted */
+  unsigned int evicted;
+  unsigned int type_count[INFO_TYPE_MAX];
+  size_t dead_text;       /* arena bytes of evicted rows */
+
+  xintern_t *paths;
+  xintern_t *flags;
+  xintern_t *templates;
+  xarena_t text;
+  xbitset_t alive;        /* rows not evicted */
+
+  xskiplist_t *index[FSORT_MAX];
+  xskiplist_t *subsets[FSTORE_MAX_SUBSETS];
+  xtrigram_t *grams;      /* over the descriptions */
+  ftree_t *tree;          /* the rows counted by directory */
+
+  fstore_height_f height; /* 1 line a row if not set */
+  void *height_ctx;
+}fstore_t;
+
+info_type_t info_type_get(const char *typestr);
+const char *info_type_name(info_type_t type);
+const char *fsort_name(fsort_t sort);
+
+/* shrink derives the display form of a path */
+fstore_t *fstore_create(xintern_derive_f shrink);
+void fstore_destroy(fstore_t *store);
+void fstore_flush(fstore_t *store);
+
+/*
+ * parse a gcc line into info, info->desc points into line.
+ * return -1 if it is not a diagnostic line
+ */
+int fstore_parse(fstore_t *store, const char *line, finfo_t *info);
+
+/* 
+ * the description with what is quoted turned into '*' and the numbers
+ * which are not a part of a name into N, return its length
+ */
+int fstore_templatize(const char *desc, char *buf, int size);
+
+/* copy: duplicate desc into the arena, return the row id or FSTORE_NONE */
+unsigned int fstore_insert(fstore_t *store, const finfo_t *info, int copy);
+
+/* 
+ * the same, the row arrives right after row after and the rows put there
+ * before it, not at the end
+ */
+unsigned int fstore_insert_after(fstore_t *store, const finfo_t *info, 
+                                 int copy, unsigned int after);
+unsigned int fstore_add_line(fstore_t *store, const char *line);
+
+static inline finfo_t *fstore_row(fstore_t *store, unsigned int id)
+{
+  return id < store->count ? &store->rows[id] : NULL;
+}
+
+static inline unsigned int fstore_count(fstore_t *store)
+{
+  return store->count;
+}
+
+static inline unsigned int fstore_live(fstore_t *store)
+{
+  return store->live;
+}
+
+static inline unsigned int fstore_type_count(fstore_t *store, info_type_t type)
+{
+  return store->type_count[type];
+}
+
+static inline xskiplist_t *fstore_index(fstore_t *store, fsort_t sort)
+{
+  return store->index[sort];
+}
+
+/* remove a row from every index, its id stays as a tombstone */
+int fstore_evict(fstore_t *store, unsigned int id);
+
+/* an empty subset index in sort order, NULL if there are too many */
+xskiplist_t *fstore_subset_create(fstore_t *store, fsort_t sort);
+void fstore_subset_destroy(fstore_t *store, xskiplist_t *subset);
+
+/* put the rows of subset in another order, O(m log m) */
+void fstore_subset_sort(fstore_t *store, xskiplist_t *subset, fsort_t sort);
+
+/* 
+ * put ids in sort order, O(m log m) and O(m) if they are in order already.
+ * feed the result to xskiplist_build(). return -1 if it runs out of memory
+ */
+int fstore_sort_ids(fstore_t *store, fsort_t sort, unsigned int *ids,
+                    unsigned int count);
+
+/* the order of a full or a subset index */
+fsort_t fstore_index_sort(fstore_t *store, xskiplist_t *index);
+
+/* bytes held by the rows, the text arena, the interns and the indexes */
+size_t fstore_bytes(fstore_t *store);
+
+/*
+ * evict rows until fstore_bytes() is below budget: notes first, then
+ * warnings oldest first, errors are always kept. return the evicted count.
+ *
+ * the text, the index nodes and the trigrams of a row are given back, its
+ * finfo_t stays as a tombstone since ids are never reused. so the budget
+ * is reached again only while the tombstones, 40 bytes a row, fit in it
+ */
+unsigned int fstore_trim(fstore_t *store, size_t budget);
+
+/* 
+ * ranks in index, -1 if there is none. errors are counted in the index,
+ * O(log n). files are searched in the file and flag orders, O(log n), the
+ * arrival orders have no key for them and the rows of the current file are
+ * walked, O(length of its run), up to O(n) when one file floods the index
+ */
+long fstore_next_error(fstore_t *store, xskiplist_t *index, unsigned long rank);
+long fstore_next_file(fstore_t *store, xskiplist_t *index, unsigned long rank);
+
+/* 
+ * set how many lines a row takes and weigh all rows again, O(n). call it
+ * again whenever the heights change, after a new wrap width for example
+ */
+void fstore_set_height(fstore_t *store, fstore_height_f height, void *ctx);
+
+/* screen lines of the rows before rank in index, and of all of them */
+unsigned long long fstore_lines_above(fstore_t *store, xskiplist_t *index, 
+                                      unsigned long rank);
+unsigned long long fstore_lines(fstore_t *store, xskiplist_t *index);
+
+/* rank of the row covering screen line, -1 past the end */
+long fstore_row_at_line(fstore_t *store, xskiplist_t *index, 
+                        unsigned long long line);
+
+const char *fstore_path(fstore_t *store, const finfo_t *info);
+const char *fstore_path_alias(fstore_t *store, const finfo_t *info);
+const char *fstore_flag(fstore_t *store, const finfo_t *info);
+const char *fstore_template(fstore_t *store, const finfo_t *info);
+
+#endif /* FSTORE_H */
@@ -0,0 +1,109 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Directory tree of the diagnostics: a trie over the path components, which
+ * are interned once. Every node counts the rows under it by kind, a row
+ * added or evicted updates its file and each directory above it, O(depth).
+ *
+ * The listing shows the children of the open directories by name, and a
+ * chain of directories with a lone subdirectory each is one row, like
+ * "home/me/proj/src/".
+ */
+
+#ifndef FTREE_H
+#define FTREE_H
+
+#include <stddef.h>
+
+#include "xintern.h"
+
+#define FTREE_NONE  ((unsigned int)-1)
+#define FTREE_ROOT  0
+#define FTREE_KINDS 4  /* one counter per info_type_t */
+
+typedef struct
+{
+  unsigned int parent;
+  unsigned int child;   /* first child or FTREE_NONE */
+  unsigned int next;    /* next sibling or FTREE_NONE */
+  unsigned int name;    /* component id in names */
+  unsigned int count[FTREE_KINDS];
+  unsigned char file;   /* a path ends here */
+  unsigned char open;   /* its children are listed */
+  unsigned char sorted; /* its children are by name */
+}ftree_node_t;
+
+/* one listed row, the label runs from first down to node */
+typedef struct
+{
+  unsigned int node;
+  unsigned int first;
+  unsigned int depth;
+}ftree_row_t;
+
+typedef struct
+{
+  ftree_node_t *nodes;   /* indexed by node id, the root is 0 */
+  unsigned int count;
+  unsigned int size;
+
+  xintern_t *names;
+  unsigned int *slots;   /* (parent, name) to node id + 1 */
+  unsigned int slot_mask;
+
+  unsigned int *files;   /* path id to node id */
+  unsigned int file_size;
+
+  ftree_row_t *rows;     /* the last listing */
+  unsigned int row_size;
+}ftree_t;
+
+ftree_t *ftree_create(void);
+void ftree_destroy(ftree_t *tree);
+void ftree_flush(ftree_t *tree);
+
+/* 
+ * count a row of kind in path, which the caller interned as path_id. the
+ * path is only split the first time, return the file node or FTREE_NONE
+ */
+unsigned int ftree_add(ftree_t *tree, unsigned int path_id, const char *path,
+                       int kind);
+void ftree_remove(ftree_t *tree, unsigned int path_id, int kind);
+
+static inline ftree_node_t *ftree_node(ftree_t *tree, unsigned int id)
+{
+  return id < tree->count ? &tree->nodes[id] : NULL;
+}
+
+/* all the rows under node */
+unsigned int ftree_total(ftree_t *tree, unsigned int id);
+
+/* the rows shown with the open directories expanded, return the count */
+unsigned int ftree_list(ftree_t *tree, ftree_row_t **rows);
+
+/* "a/b/c/" for a row, "/a/b/c" for the path of a node. return the length */
+int ftree_label(ftree_t *tree, const ftree_row_t *row, char *buf, int size);
+int ftree_path(ftree_t *tree, unsigned int id, char *buf, int size);
+
+size_t ftree_bytes(ftree_t *tree);
+
+#endif /* FTREE_H */
@@ -0,0 +1,96 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Viewport over one sort index of the store. The position is a rank, so
+ * every jump is a lookup in the index: home, end and percentages are
+ * O(1), the next error or file is O(log n) whatever the list size.
+ *
+ * Pages are counted in screen lines, a wrapped row takes several. The
+ * indexes sum the row heights, so mapping a line to a row is O(log n).
+ *
+ * A subset index, search matches for example, can be shown instead of all
+ * the rows, it is navigated the same way.
+ */
+
+#ifndef FVIEW_H
+#define FVIEW_H
+
+#include "fstore.h"
+
+typedef struct
+{
+  fstore_t *store;
+  fsort_t sort;
+  unsigned long long top;  /* rank of the first row shown */
+  unsigned int page;       /* lines on a screen */
+  int follow;              /* stay at the end as rows come, see fview_end() */
+  xskiplist_t *subset;     /* the rows shown, NULL for all of them */
+}fview_t;
+
+void fview_init(fview_t *view, fstore_t *store);
+
+static inline xskiplist_t *fview_index(fview_t *view)
+{
+  return view->subset ? view->subset : fstore_index(view->store, view->sort);
+}
+
+static inline unsigned long long fview_count(fview_t *view)
+{
+  return xskiplist_count(fview_index(view));
+}
+
+/* the id of the top row or FSTORE_NONE */
+unsigned int fview_top_id(fview_t *view);
+
+/* show subset or all the rows if NULL, row id goes on top if it is there */
+void fview_set_subset(fview_t *view, xskiplist_t *subset, unsigned int id);
+
+/* keep top a valid rank after rows come or go */
+void fview_clamp(fview_t *view);
+
+/* switch the sort order, of the subset too, the top row stays on top */
+void fview_sort(fview_t *view, fsort_t sort);
+
+void fview_set_page(fview_t *view, unsigned int page);
+
+/* move by rows, negative is up */
+void fview_scroll(fview_t *view, long long rows);
+
+/* move by a screen of lines, negative is up */
+void fview_page(fview_t *view, int pages);
+
+void fview_home(fview_t *view);
+
+/* 
+ * go to the end and follow it: fview_clamp() keeps the last page shown
+ * while rows come, till any other move
+ */
+void fview_end(fview_t *view);
+
+/* put the row at percent [0, 100] of the list on top */
+void fview_percent(fview_t *view, int percent);
+
+/* return -1 and stay if there is no such row below top */
+int fview_next_error(fview_t *view);
+int fview_next_file(fview_t *view);
+
+#endif /* FVIEW_H */
@@ -29,10 +29,68 @@ extern "C" {
 #include <stdio.h>
 #include <signal.h>
 
+/* bytes kept between reads, also the most keys one read can give */
+#define TERMINAL_KEY_BUF 4096
+#define TERMINAL_ESC_MS  50    /* an ESC with nothing after it is a key */
+
+typedef enum
+{
+  TERMINAL_KEY_CHAR,      /* a plain byte, see terminal_key_t.c */
+  TERMINAL_KEY_UP,
+  TERMINAL_KEY_DOWN,
+  TERMINAL_KEY_LEFT,
+  TERMINAL_KEY_RIGHT,
+  TERMINAL_KEY_PGUP,
+  TERMINAL_KEY_PGDN,
+  TERMINAL_KEY_HOME,
+  TERMINAL_KEY_END,
+  TERMINAL_KEY_WHEEL_UP,
+  TERMINAL_KEY_WHEEL_DOWN,
+}terminal_keycode_t;
+
+typedef struct
+{
+  terminal_keycode_t code;
+  unsigned char c;
+}terminal_key_t;
+
 void terminal_init();
 void terminal_reset();
 char terminal_ctrlc();
 
+/*
+ * drain fd with one read and parse every complete key in it: arrows,
+ * home/end/pgup/pgdn in their CSI, SS3 and "~" forms, SGR mouse wheel.
+ * an incomplete sequence waits for the next call. return the key count
+ */
+int terminal_read_keys(int fd, terminal_key_t *keys, int max);
+
+/* 
+ * an incomplete sequence is waiting. a lone ESC is one until no more
+ * bytes come, wait TERMINAL_ESC_MS for them, then terminal_flush_keys()
+ * makes the bytes keys by themselves
+ */
+int terminal_keys_pending();
+int terminal_flush_keys(terminal_key_t *keys, int max);
+
+/* 
+ * the geometry is cached, it is only queried again by terminal_winch()
+ * after a SIGWINCH, so reading it never makes a syscall
+ */
+void terminal_geometry(int *width, int *height);
+
+/* readable after a SIGWINCH, add it to select() */
+int terminal_winch_fd();
+
+/* drain the SIGWINCH events, return 1 if the geometry changed */
+int terminal_winch();
+
+/* bytes written to fd the terminal has not taken yet, -1 if unknown */
+int terminal_backlog(int fd);
+
+/* TIOCGWINSZ, falls back to LINES/COLUMNS, then 80x24 */
+int get_terminal_width_height(int fd, int *width, int *height);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,59 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Text arena: small strings are packed into big chunks, there is no
+ * per-string free, the whole arena is flushed at once.
+ */
+
+#ifndef XARENA_H
+#define XARENA_H
+
+#include <stddef.h>
+
+#define XARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct xarena_chunk
+{
+  struct xarena_chunk *next;
+  size_t size;
+  size_t used;
+  char data[];
+}xarena_chunk_t;
+
+typedef struct
+{
+  xarena_chunk_t *head;   /* the current chunk, older ones follow */
+  size_t bytes;           /* allocated from the system */
+  size_t used;            /* handed out */
+}xarena_t;
+
+void xarena_init(xarena_t *arena);
+void xarena_flush(xarena_t *arena);
+
+void *xarena_alloc(xarena_t *arena, size_t size);
+/* copy len bytes of str with a trailing '\0' */
+char *xarena_strndup(xarena_t *arena, const char *str, size_t len);
+
+size_t xarena_bytes(xarena_t *arena);
+size_t xarena_used(xarena_t *arena);
+
+#endif /* XARENA_H */
@@ -0,0 +1,66 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Growable bitset over 32-bit ids, 64 bits a word. The set operations go
+ * a word at a time, bits past the end of a set are 0.
+ */
+
+#ifndef XBITSET_H
+#define XBITSET_H
+
+#include <stddef.h>
+
+typedef struct
+{
+  unsigned long long *words;
+  unsigned int size;   /* words */
+}xbitset_t;
+
+void xbitset_init(xbitset_t *set);
+void xbitset_release(xbitset_t *set);
+
+/* grow to hold bit, return -1 if it can't */
+int xbitset_set(xbitset_t *set, unsigned int bit);
+void xbitset_clear(xbitset_t *set, unsigned int bit);
+
+static inline int xbitset_test(const xbitset_t *set, unsigned int bit)
+{
+  return bit / 64 < set->size && (set->words[bit / 64] >> (bit % 64) & 1);
+}
+
+/* all bits 0, the memory is kept */
+void xbitset_zero(xbitset_t *set);
+
+/* dst = src, dst |= src, dst &= src, dst &= ~src */
+int xbitset_copy(xbitset_t *dst, const xbitset_t *src);
+int xbitset_or(xbitset_t *dst, const xbitset_t *src);
+void xbitset_and(xbitset_t *dst, const xbitset_t *src);
+void xbitset_andnot(xbitset_t *dst, const xbitset_t *src);
+
+unsigned long xbitset_count(const xbitset_t *set);
+
+/* the first bit set at or after from, -1 if there is none */
+long xbitset_next(const xbitset_t *set, unsigned int from);
+
+size_t xbitset_bytes(const xbitset_t *set);
+
+#endif /* XBITSET_H */
@@ -80,21 +80,44 @@ void xdumphex(const void *addr, unsigned int len);
 #define CURSOR_SHOW  "\033[?25h"
 #define SCREEN_CLEAR "\033[H\033[J"
 
+/* a color spec compiled into its escape sequence, coloring is a memcpy */
+typedef struct
+{
+  const char *spec;
+  char code[16];
+  unsigned char len;
+}xcolor_t;
+
+/* handles of the common specs, compiled at build time */
+extern const xcolor_t xcolor_normal;
+extern const xcolor_t xcolor_red_bold;
+extern const xcolor_t xcolor_green_bold;
+extern const xcolor_t xcolor_yellow_bold;
+
+/* compile any other spec once, the same handle is returned for it later */
+const xcolor_t *color_compile(const char *spec);
+
 void color_fprintf(FILE *fp, const char *color, const char *fmt, ...)__attribute__((format(printf, 3, 4)));
+void xcolor_fprintf(FILE *fp, const xcolor_t *color, const char *fmt, ...)__attribute__((format(printf, 3, 4)));
+
+/* like vsnprintf, the output is wrapped with the color codes */
+int xcolor_vsnprintf(char *buf, size_t size, const xcolor_t *color, 
+                     const char *fmt, va_list args);
  
 /* xcprintf dump info with color discipline
- * color can be "foreground background textstyle"
+ * color is a handle, from color_compile() for specs like
+ * "foreground background textstyle"
  * foreground/background can be "red/green/yellow/blue/magenata/cyan"
  * textstyle can be "bold/empty"
  */
-#define xcprintf(color, fmt...) color_fprintf(stdout, color, fmt)
+#define xcprintf(color, fmt...) xcolor_fprintf(stdout, color, fmt)
 
 /* xwprintf throws out warning info with red color */
-#define xwprintf(fmt...)  xcprintf("red bold", fmt)
+#define xwprintf(fmt...)  xcprintf(&xcolor_red_bold, fmt)
 /* xwprintf throws out normal info with green color */
-#define xiprintf(fmt...)  xcprintf("green bold", fmt)
+#define xiprintf(fmt...)  xcprintf(&xcolor_green_bold, fmt)
 /* for warning */
-#define xnprintf(fmt...)  xcprintf("yellow bold", fmt)
+#define xnprintf(fmt...)  xcprintf(&xcolor_yellow_bold, fmt)
 
 /* At least given one parameter for gcc variable length parameter usage 
  * xprintf(), xerror, xdie()... will encounter complaint by GCC.
@@ -113,7 +136,7 @@ void color_fprintf(FILE *fp, const char *color, const char *fmt, ...)__attribute
 /*xerror dump info to stderr */
 #define xerror(x...)  {\
                         _xprintf(stderr, __FILE__, __LINE__, __FUNCTION__, x); \
-                        color_fprintf(stderr, "red bold", "Tracing: %s\n", errno ? strerror(errno) : "Tracing failed"); \
+                        xcolor_fprintf(stderr, &xcolor_red_bold, "Tracing: %s\n", errno ? strerror(errno) : "Tracing failed"); \
                       }
 
 #ifdef XDEBUG_CGI
@@ -0,0 +1,128 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Many globs matched in one pass. Each glob is anchored at both ends,
+ * '*' is any run of bytes and '?' any one byte, '\' takes the next byte
+ * as it is. Neither wildcard crosses the separator byte, so a glob can
+ * match several fields joined by it, one field each part.
+ *
+ * The globs are compiled together into one automaton: the positions of
+ * all the glob tokens are bits, a byte moves the set of live positions in
+ * a few word-wide shifts and masks (shift-and), the bytes are folded into
+ * the classes the globs tell apart first. Every set met becomes a DFA
+ * state whose transitions are cached, so matching is one table lookup a
+ * byte whatever the number of globs.
+ *
+ * Many globs can blow a DFA up, so the states are only built as input
+ * needs them and the cache is started over when it is full. Globs must be
+ * added in bit order: the first one matching wins, a position is dropped
+ * while an earlier glob has one with the same tokens left.
+ */
+
+#ifndef XDFA_H
+#define XDFA_H
+
+#include <stddef.h>
+
+#define XDFA_MAX_GLOBS  64
+#define XDFA_MAX_STATES 4096
+#define XDFA_DEAD       0            /* no glob can match any more */
+#define XDFA_UNKNOWN    0xffffffffU  /* a transition not built yet */
+
+typedef struct
+{
+  unsigned char sep;
+
+  /* the globs as tokens, a position each */
+  short *tokens;
+  unsigned char *owner;       /* the bit of the glob of each position */
+  unsigned int count;
+  unsigned int size;
+
+  /* the positions as bit masks, built by xdfa_compile() */
+  unsigned int words;
+  unsigned char classes[256];
+  int class_count;
+  unsigned long long *adv;    /* [class]: takes a byte of it, moves on */
+  unsigned long long *stay;   /* [class]: a '*' which takes it */
+  unsigned long long *star;   /* may match nothing */
+  unsigned long long *ends;   /* a glob matched */
+  unsigned int *twin;         /* the position before with the same tokens 
+                                 left, or XDFA_UNKNOWN */
+
+  /* the states built so far */
+  unsigned long long *sets;   /* [state] */
+  unsigned int *next;         /* [state * class_count + class] */
+  unsigned long long *accept; /* [state], bits of the globs matched */
+  unsigned int states;
+  unsigned int *table;        /* state + 1 by the hash of its set */
+  unsigned int mask;
+  unsigned long long *scratch;
+  unsigned long flushes;      /* the cache was full and started over */
+}xdfa_t;
+
+xdfa_t *xdfa_create(unsigned char sep);
+void xdfa_destroy(xdfa_t *dfa);
+
+/* 
+ * add a glob of len bytes, bit is its bit in the accept masks, never less
+ * than the one before. return -1 if bit is out of range
+ */
+int xdfa_add(xdfa_t *dfa, const char *glob, size_t len, int bit);
+
+/* build the masks and the start state, return -1 if it fails */
+int xdfa_compile(xdfa_t *dfa);
+
+/* the state after state takes a byte of class cls, built on first use */
+unsigned int xdfa_build(xdfa_t *dfa, unsigned int state, int cls);
+
+static inline unsigned int xdfa_start(const xdfa_t *dfa)
+{
+  return 1;
+}
+
+static inline unsigned int xdfa_step(xdfa_t *dfa, unsigned int state,
+                                     unsigned char c)
+{
+  int cls = dfa->classes[c];
+  unsigned int next = dfa->next[state * dfa->class_count + cls];
+
+  return next != XDFA_UNKNOWN ? next : xdfa_build(dfa, state, cls);
+}
+
+/* feed len bytes of str from state, stop early at XDFA_DEAD */
+unsigned int xdfa_feed(xdfa_t *dfa, unsigned int state, 
+                       const char *str, size_t len);
+
+/* 
+ * the globs matched at state, the lowest bit is the first glob which 
+ * matches. the later ones are left out where an earlier one matches
+ */
+static inline unsigned long long xdfa_accept(const xdfa_t *dfa, 
+                                             unsigned int state)
+{
+  return dfa->accept[state];
+}
+
+size_t xdfa_bytes(const xdfa_t *dfa);
+
+#endif /* XDFA_H */
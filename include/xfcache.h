@@ -0,0 +1,94 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Source file cache: files are read into memory and kept in LRU order, the
+ * least recent ones are dropped past a file count or a size in memory.
+ * They are read with pread() rather than mapped, a file truncated while
+ * it is looked at gives a short read instead of a SIGBUS.
+ *
+ * The start of every line is indexed lazily, a lookup only searches for
+ * newlines up to the line it wants and at most a budget of bytes per call,
+ * so a huge generated file never stalls the caller: the lookup returns
+ * XFCACHE_AGAIN and goes on from there the next time. A file is read as
+ * far as it is searched, a window at a time. Indexed lines are then found
+ * at once.
+ *
+ * A file is checked with stat() at each lookup, a new mtime or size reads
+ * it again.
+ */
+
+#ifndef XFCACHE_H
+#define XFCACHE_H
+
+#include <stddef.h>
+#include <time.h>
+
+#include "xlist.h"
+
+#define XFCACHE_AGAIN (-2)               /* the index is not there yet */
+#define XFCACHE_SCAN  (4 * 1024 * 1024)  /* bytes indexed per lookup */
+
+typedef struct
+{
+  struct xlist_head lru;
+  char *path;
+  unsigned int hash;
+
+  const char *data;   /* the file, NULL if it can't be read */
+  size_t size;        /* as stat() said, less if it got shorter since */
+  size_t loaded;      /* bytes of data read so far */
+  size_t bytes;       /* allocated for data */
+  struct timespec mtime;
+  int advised;        /* readahead was asked for */
+
+  size_t *lines;      /* offsets of the line starts found so far */
+  unsigned int line_count;
+  unsigned int line_size;
+  size_t scanned;     /* bytes searched for newlines */
+}xfcache_file_t;
+
+typedef struct
+{
+  struct xlist_head lru;  /* most recent first */
+  unsigned int count;
+  unsigned int max_files;
+  size_t bytes;           /* allocated for the files */
+  size_t max_bytes;
+}xfcache_t;
+
+xfcache_t *xfcache_create(unsigned int max_files, size_t max_bytes);
+void xfcache_destroy(xfcache_t *cache);
+
+/* the file of path checked and made the most recent one, NULL on no memory */
+xfcache_file_t *xfcache_get(xfcache_t *cache, const char *path);
+
+/* ask the kernel to read path ahead, it is not checked again */
+void xfcache_prefetch(xfcache_t *cache, const char *path);
+
+/* 
+ * line n (from 1) of file into text, without its '\n'. return the length,
+ * -1 past the end or if the file can't be read, XFCACHE_AGAIN if the index
+ * has not reached it yet
+ */
+long xfcache_line(xfcache_file_t *file, unsigned int n, const char **text);
+
+#endif /* XFCACHE_H */
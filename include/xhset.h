@@ -0,0 +1,75 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Set of 64-bit keys, open addressing with linear probing. The keys are
+ * meant to be hashes already, xhset_hash() makes one from several fields.
+ * 0 is a key like any other, it is kept aside from the free slots.
+ */
+
+#ifndef XHSET_H
+#define XHSET_H
+
+#include <stddef.h>
+
+#define XHSET_SEED 14695981039346656037ULL
+
+typedef struct
+{
+  unsigned long long *slots;  /* 0 is a free slot */
+  unsigned int mask;
+  unsigned int count;         /* keys, the zero one too */
+  int zero;                   /* 0 is in the set */
+}xhset_t;
+
+void xhset_init(xhset_t *set);
+void xhset_release(xhset_t *set);
+
+/* no keys, the memory is kept */
+void xhset_flush(xhset_t *set);
+
+/* return 1 if key is new, 0 if it was there, -1 if the set can't grow */
+int xhset_add(xhset_t *set, unsigned long long key);
+int xhset_has(const xhset_t *set, unsigned long long key);
+
+/* FNV-1a of len bytes going on from hash, start with XHSET_SEED */
+static inline unsigned long long xhset_hash(unsigned long long hash,
+                                            const void *data, size_t len)
+{
+  const unsigned char *ptr = data;
+
+  while(len--)
+  {
+    hash ^= *ptr++;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+static inline unsigned int xhset_count(const xhset_t *set)
+{
+  return set->count;
+}
+
+size_t xhset_bytes(const xhset_t *set);
+
+#endif /* XHSET_H */
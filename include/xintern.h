@@ -0,0 +1,77 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * String intern table: every distinct string is stored once and given a
+ * 32-bit id. An optional derive hook computes an alias (a display form
+ * for example) once when the string is first seen, then it is cached.
+ */
+
+#ifndef XINTERN_H
+#define XINTERN_H
+
+#include <stddef.h>
+
+#define XINTERN_NONE ((unsigned int)-1)
+
+/* return a malloced alias of str or NULL */
+typedef char *(*xintern_derive_f)(const char *str);
+
+typedef struct
+{
+  char *str;
+  char *alias;
+  unsigned int hash;
+  unsigned int len;
+}xintern_entry_t;
+
+typedef struct
+{
+  xintern_entry_t *entries; /* indexed by id */
+  unsigned int count;
+  unsigned int size;
+
+  unsigned int *slots;      /* open addressing, stores id + 1 */
+  unsigned int slot_mask;
+
+  xintern_derive_f derive;
+  size_t bytes;             /* memory held by the table */
+}xintern_t;
+
+xintern_t *xintern_create(xintern_derive_f derive);
+void xintern_destroy(xintern_t *tab);
+
+/* drop all strings, ids restart from 0 */
+void xintern_flush(xintern_t *tab);
+
+/* len < 0 means strlen(str), return the id or XINTERN_NONE */
+unsigned int xintern_add(xintern_t *tab, const char *str, int len);
+unsigned int xintern_find(xintern_t *tab, const char *str, int len);
+
+const char *xintern_str(xintern_t *tab, unsigned int id);
+
+/* the derived string, falls back to the string itself */
+const char *xintern_alias(xintern_t *tab, unsigned int id);
+
+unsigned int xintern_count(xintern_t *tab);
+size_t xintern_bytes(xintern_t *tab);
+
+#endif /* XINTERN_H */
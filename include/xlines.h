@@ -0,0 +1,64 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Line assembly over a byte stream: reads land in one buffer and complete
+ * lines are handed out in place, the partial line at the end waits for the
+ * next read. A line is never cut by the size of a read, only past
+ * XLINES_MAX: its first XLINES_MAX bytes are kept and the rest is dropped
+ * up to the '\n', so the buffer stays bounded whatever comes in.
+ */
+
+#ifndef XLINES_H
+#define XLINES_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define XLINES_READ (64 * 1024)    /* bytes asked for by a read */
+#define XLINES_MAX  (1024 * 1024)  /* bytes kept of a line */
+
+typedef struct
+{
+  char *buf;
+  size_t start;   /* the first byte not handed out */
+  size_t scan;    /* no '\n' in [start, scan) */
+  size_t len;
+  size_t size;
+  int cut;        /* the partial line is too long, the rest is dropped */
+}xlines_t;
+
+void xlines_init(xlines_t *lines);
+void xlines_release(xlines_t *lines);
+
+/* one read() of fd, return its result, -1 also if the buffer can't grow */
+ssize_t xlines_read(xlines_t *lines, int fd);
+
+/* 
+ * the next complete line without its "\n" or "\r\n", NULL if there is none
+ * yet. it stays valid till the next read
+ */
+char *xlines_next(xlines_t *lines);
+
+/* the line the stream ended in without a '\n', NULL if there is none */
+char *xlines_rest(xlines_t *lines);
+
+#endif /* XLINES_H */
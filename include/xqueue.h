@@ -48,16 +48,35 @@ typedef struct
   
   xqueue_traverse_f traverse;
   xqueue_free_f free;
+  
+  /* ring mode: nodes are preallocated, the oldest one is overwritten */
+  xqnode_t *pool;
+  struct xlist_head free_nodes;
+  unsigned int overwritten;
 }xqueue_t;
 
 /* if size is 0 then no limit, -1 with default */
 xqueue_t *xqueue_create(int size, xqueue_free_f free);
+
+/* 
+ * a bounded ring of size nodes (-1 with default), when it is full the
+ * oldest data is released and its node is reused, no malloc on enqueue
+ */
+xqueue_t *xqueue_create_ring(int size, xqueue_free_f free);
 void xqueue_traverse(xqueue_t *head, xqueue_traverse_f traverse);
 void xqueue_traverse_fromto(xqueue_t *head, xqueue_traverse_f traverse, int from_idx, int to_idx);
 
 void xqueue_dump(xqueue_t *head);
 
 int xqueue_enqueue(xqueue_t *head, void *data);
+
+/* 
+ * the oldest node, NULL if there is none. its data is the caller's, the
+ * node itself goes back with xqueue_release(), never free() it: a ring
+ * node lives in the pool
+ */
+xqnode_t *xqueue_dequeue(xqueue_t *head);
+void xqueue_release(xqueue_t *head, xqnode_t *node);
 void xqueue_destroy(xqueue_t *head);
 
 /* flush away all data nodes */
@@ -65,6 +84,9 @@ void xqueue_flush(xqueue_t *head);
 
 unsigned int xqueue_nodes(xqueue_t *head);
 
+/* how many entries a ring has overwritten */
+unsigned int xqueue_overwritten(xqueue_t *head);
+
 void xqueue_handle(xqueue_t *head, xqueue_handle_f handle);
 
 #endif /* XQUEUE_H */
@@ -0,0 +1,125 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Differential screen: a frame is composed line by line into the back
+ * buffer, flushing compares it with the front buffer (what the terminal
+ * shows now) and only the changed lines are sent out. An unchanged frame
+ * costs nothing.
+ *
+ * The changed lines are gathered in one reusable output buffer and handed
+ * to the terminal with a single write(), stdio is not involved. The write
+ * never blocks, what a slow terminal can't take yet stays pending and the
+ * caller should not compose new frames till it is drained.
+ *
+ * Lines from the scroll top down to the scroll bottom form a scroll region:
+ * when the new frame is the old one moved up, the terminal scrolls the
+ * region itself (DECSTBM) and only the lines that came in at its bottom
+ * are written.
+ *
+ * A write which can't finish also starts measuring how fast the terminal
+ * takes bytes, frames can then be paced below that rate so the kernel
+ * buffer empties instead of holding seconds of old frames.
+ */
+
+#ifndef XSCREEN_H
+#define XSCREEN_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "xdebug.h"
+
+typedef struct
+{
+  char *text;      /* with color codes, no '\n' */
+  size_t len;
+  size_t size;
+  int cols;        /* visible columns */
+}xsline_t;
+
+typedef struct
+{
+  int width;
+  int height;
+
+  xsline_t *front;
+  xsline_t *back;
+  int cur;         /* the line being composed */
+
+  int full;        /* clear and repaint everything on the next flush */
+  int scroll_top;  /* first line of the scroll region, the height if none */
+  int scroll_bottom;  /* the line below it, clipped to the height */
+  unsigned long scrolls;  /* frames sent as a region scroll */
+
+  char *out;       /* the frame to write, reused */
+  size_t out_len;
+  size_t out_size;
+  size_t out_pos;  /* written so far, the rest is pending */
+  size_t last_len; /* bytes of the last frame */
+
+  /* the terminal rate, measured while the output is congested */
+  int congested;
+  unsigned long long congested_at;  /* us */
+  size_t congested_bytes;
+  double rate;     /* bytes a second, 0 if it never congested */
+
+  unsigned long frames;  /* frames which wrote something */
+  unsigned long writes;  /* write() calls */
+}xscreen_t;
+
+xscreen_t *xscreen_create(void);
+void xscreen_destroy(xscreen_t *scr);
+
+/* a new geometry always leads to a full repaint */
+void xscreen_resize(xscreen_t *scr, int width, int height);
+void xscreen_invalidate(xscreen_t *scr);
+
+/* 
+ * lines [top, bottom) may be scrolled by the terminal, bottom is clipped to
+ * the height and an empty region is off
+ */
+void xscreen_set_scroll(xscreen_t *scr, int top, int bottom);
+
+/* start a new frame, all back lines are emptied */
+void xscreen_begin(xscreen_t *scr);
+
+/* append to the current line, text over the width is cut */
+void xscreen_printf(xscreen_t *scr, const xcolor_t *color, const char *fmt, ...)
+                    __attribute__((format(printf, 3, 4)));
+void xscreen_newline(xscreen_t *scr);
+
+/* lines left below the current one */
+int xscreen_lines_left(xscreen_t *scr);
+
+/* send the changed lines to fd in one write, return the frame bytes */
+size_t xscreen_flush(xscreen_t *scr, int fd);
+
+/* bytes of the frames the terminal has not taken yet */
+size_t xscreen_pending(xscreen_t *scr);
+
+/* write more of the pending bytes, return what is still pending */
+size_t xscreen_drain(xscreen_t *scr, int fd);
+
+/* how long the last frame takes at the measured rate, 0 if unknown */
+unsigned long long xscreen_pace_us(xscreen_t *scr);
+
+#endif /* XSCREEN_H */
@@ -0,0 +1,131 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Indexable skip list over 32-bit ids. The order is given by a compare
+ * hook, every link keeps its span so insert, remove, rank and the n-th
+ * lookup are all O(log n).
+ *
+ * An optional weigh hook gives every node XSKIPLIST_SUMS weights, links
+ * keep the sums of the weights they jump over the same way as the spans,
+ * so prefix sums and seeking by a sum are O(log n) as well.
+ */
+
+#ifndef XSKIPLIST_H
+#define XSKIPLIST_H
+
+#include <stddef.h>
+
+#define XSKIPLIST_MAX_LEVEL 24
+#define XSKIPLIST_SUMS      2
+
+/* <0, 0, >0 like strcmp, must be a total order over ids */
+typedef int (*xskiplist_cmp_f)(void *ctx, unsigned int id1, unsigned int id2);
+
+/* fill weights[XSKIPLIST_SUMS] of id, they must not change in the list */
+typedef void (*xskiplist_weigh_f)(void *ctx, unsigned int id, 
+                                  unsigned int *weights);
+
+/* non zero while id is before the searched point, see xskiplist_search() */
+typedef int (*xskiplist_pred_f)(void *ctx, unsigned int id, const void *key);
+
+typedef struct xsknode xsknode_t;
+
+typedef struct
+{
+  xsknode_t *next;
+  unsigned int span;  /* how many nodes the link jumps over */
+  unsigned int sum[XSKIPLIST_SUMS]; /* and their weights */
+}xsklink_t;
+
+struct xsknode
+{
+  unsigned int id;
+  unsigned int level;
+  unsigned int weight[XSKIPLIST_SUMS];
+  xsklink_t link[];
+};
+
+typedef struct
+{
+  xsknode_t *head;
+  unsigned int level;
+  unsigned int count;
+  unsigned int seed;
+  size_t bytes;       /* memory held by the nodes */
+
+  unsigned long long sum[XSKIPLIST_SUMS]; /* all the weights */
+
+  xskiplist_cmp_f cmp;
+  xskiplist_weigh_f weigh;
+  void *ctx;
+}xskiplist_t;
+
+xskiplist_t *xskiplist_create(xskiplist_cmp_f cmp, void *ctx);
+void xskiplist_destroy(xskiplist_t *list);
+void xskiplist_flush(xskiplist_t *list);
+
+/* return the rank of the new node or -1 */
+long xskiplist_insert(xskiplist_t *list, unsigned int id);
+
+/* 
+ * replace the nodes with ids, which must be in the list order already.
+ * O(count) with no compare, return -1 if it runs out of memory
+ */
+int xskiplist_build(xskiplist_t *list, const unsigned int *ids, 
+                    unsigned int count);
+int xskiplist_remove(xskiplist_t *list, unsigned int id);
+
+/* the node at rank [0, count) or NULL */
+xsknode_t *xskiplist_at(xskiplist_t *list, unsigned long rank);
+/* rank of id or -1 if it is not in the list */
+long xskiplist_rank(xskiplist_t *list, unsigned int id);
+
+/* 
+ * rank of the first node for which before() returns 0, the list must be
+ * partitioned by it. return count if before() holds for every node
+ */
+long xskiplist_search(xskiplist_t *list, xskiplist_pred_f before, 
+                      const void *key);
+
+/* weigh every node with the hook, O(n), call it if the weights changed */
+void xskiplist_weigh(xskiplist_t *list, xskiplist_weigh_f weigh);
+
+/* sum of weights n of the nodes in [0, rank) */
+unsigned long long xskiplist_sum(xskiplist_t *list, int n, unsigned long rank);
+
+/* rank of the node whose weights n cover sum, -1 if sum is past the end */
+long xskiplist_seek(xskiplist_t *list, int n, unsigned long long sum);
+
+static inline xsknode_t *xskiplist_first(xskiplist_t *list)
+{
+  return list->head->link[0].next;
+}
+
+static inline xsknode_t *xskiplist_next(xsknode_t *node)
+{
+  return node->link[0].next;
+}
+
+unsigned int xskiplist_count(xskiplist_t *list);
+size_t xskiplist_bytes(xskiplist_t *list);
+
+#endif /* XSKIPLIST_H */
@@ -0,0 +1,78 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Trigram index: every id added is appended to the posting list of each
+ * distinct 3-byte sequence of its text, ASCII letters folded to lower case.
+ * A substring of 3 bytes or more can only be in the texts of the shortest
+ * posting list among its trigrams, so a query checks those texts and not
+ * all of them.
+ *
+ * Ids must be added in increasing order, the posting lists stay sorted.
+ * Removed ids stay in the lists till xtrigram_compact().
+ */
+
+#ifndef XTRIGRAM_H
+#define XTRIGRAM_H
+
+#include <stddef.h>
+
+typedef struct
+{
+  unsigned int key;   /* the trigram + 1, 0 is a free slot */
+  unsigned int count;
+  unsigned int size;
+  unsigned int *ids;
+}xtrigram_list_t;
+
+typedef struct
+{
+  xtrigram_list_t *slots;  /* open addressing over the trigrams */
+  unsigned int slot_mask;
+  unsigned int used;
+  unsigned long long postings;
+  size_t bytes;            /* memory held by the index */
+}xtrigram_t;
+
+/* non zero to keep id, see xtrigram_compact() */
+typedef int (*xtrigram_keep_f)(void *ctx, unsigned int id);
+
+xtrigram_t *xtrigram_create(void);
+void xtrigram_destroy(xtrigram_t *tab);
+void xtrigram_flush(xtrigram_t *tab);
+
+/* index text of id, id must be above all the ids added before */
+int xtrigram_add(xtrigram_t *tab, unsigned int id, const char *text, int len);
+
+/* 
+ * the ids which may contain str in any case, the shortest posting list of
+ * its trigrams. -1 if str is too short to have a trigram, everything may
+ * match then
+ */
+long xtrigram_candidates(xtrigram_t *tab, const char *str, int len, 
+                         const unsigned int **ids);
+
+/* drop the ids keep() refuses from every list, O(postings) */
+void xtrigram_compact(xtrigram_t *tab, xtrigram_keep_f keep, void *ctx);
+
+size_t xtrigram_bytes(xtrigram_t *tab);
+
+#endif /* XTRIGRAM_H */
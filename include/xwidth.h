@@ -0,0 +1,58 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Display width of utf-8 text: east asian wide and fullwidth characters
+ * take 2 columns, combining marks and zero width ones take none, the
+ * rest 1. Bytes which are not valid utf-8 take 1 column each.
+ *
+ * Most text is plain ascii, it is found 8 bytes at a time and one byte is
+ * one column there, only the other characters are decoded.
+ */
+
+#ifndef XWIDTH_H
+#define XWIDTH_H
+
+#include <stddef.h>
+
+/* columns of code point cp: 0, 1 or 2 */
+int xwidth_char(unsigned int cp);
+
+/* bytes of the ascii run str starts with, len at most */
+size_t xwidth_ascii(const char *str, size_t len);
+
+/* 
+ * decode the character str starts with, len > 0. return its bytes, *cols 
+ * is set to its columns
+ */
+int xwidth_next(const char *str, size_t len, int *cols);
+
+/* columns of len bytes of str */
+size_t xwidth_strn(const char *str, size_t len);
+size_t xwidth_str(const char *str);
+
+/* 
+ * bytes of the longest prefix of len bytes of str which fits in cols 
+ * columns, a character is never split. *used is set to its columns
+ */
+size_t xwidth_fit(const char *str, size_t len, size_t cols, size_t *used);
+
+#endif /* XWIDTH_H */
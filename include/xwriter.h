@@ -0,0 +1,63 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+/*
+ * Buffered writer on a file descriptor: the output is gathered in one
+ * buffer and written when it fills up or on a flush, there is no stdio and
+ * no locking on the way.
+ */
+
+#ifndef XWRITER_H
+#define XWRITER_H
+
+#include <stddef.h>
+
+#define XWRITER_SIZE (64 * 1024)
+
+typedef struct
+{
+  int fd;
+  char *buf;
+  size_t len;
+  size_t size;
+  int error;    /* a write failed, later writes are dropped */
+}xwriter_t;
+
+int xwriter_init(xwriter_t *writer, int fd, size_t size);
+void xwriter_release(xwriter_t *writer);
+
+/* write all that is buffered, return -1 if the fd fails */
+int xwriter_flush(xwriter_t *writer);
+
+int xwriter_write(xwriter_t *writer, const void *data, size_t len);
+int xwriter_printf(xwriter_t *writer, const char *fmt, ...)
+                   __attribute__((format(printf, 2, 3)));
+
+static inline int xwriter_putc(xwriter_t *writer, char c)
+{
+  if(writer->len == writer->size && xwriter_flush(writer) < 0)
+    return -1;
+
+  writer->buf[writer->len++] = c;
+  return 0;
+}
+
+#endif /* XWRITER_H */
@@ -0,0 +1,154 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "fbaseline.h"
+
+fbaseline_t *fbaseline_create(void)
+{
+  fbaseline_t *base = malloc(sizeof(fbaseline_t));
+  if(!base)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(base, 0, sizeof(fbaseline_t));
+  xhset_init(&base->keys);
+  return base;
+}
+
+void fbaseline_destroy(fbaseline_t *base)
+{
+  if(!base)
+    return;
+
+  xhset_release(&base->keys);
+  free(base);
+}
+
+void fbaseline_flush(fbaseline_t *base)
+{
+  base->known = 0;
+  memset(base->hits, 0, sizeof(base->hits));
+}
+
+int fbaseline_load(fbaseline_t *base, const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  char buf[1024];
+  int count = 0;
+
+  if(!fp)
+  {
+    perror(path);
+    return -1;
+  }
+
+  /* only the leading hex counts, a line longer than buf goes on as text */
+  while(fgets(buf, sizeof(buf), fp))
+  {
+    char *end = NULL;
+    unsigned long long key = 0;
+    int len = strlen(buf);
+    int whole = len && buf[len - 1] == '\n';
+
+    if(isxdigit((unsigned char)buf[0]))
+    {
+      key = strtoull(buf, &end, 16);
+      if(end == buf + 16 && (!*end || isspace((unsigned char)*end)))
+      {
+        if(xhset_add(&base->keys, key) < 0)
+          break;
+        count++;
+      }
+    }
+
+    while(!whole && fgets(buf, sizeof(buf), fp))
+    {
+      len = strlen(buf);
+      whole = len && buf[len - 1] == '\n';
+    }
+  }
+
+  fclose(fp);
+  return count;
+}
+
+/* the key of info with the template of its description in tmpl */
+static unsigned long long fbaseline_hash(fstore_t *store, const finfo_t *info,
+                                         char *tmpl, int *len)
+{
+  const char *path = fstore_path(store, info);
+  const char *flag = fstore_flag(store, info);
+  unsigned long long hash = XHSET_SEED;
+
+  /* the strings, ids are only fixed for a run, '\0' ends each field */
+  *len = fstore_templatize(info->desc, tmpl, FSTORE_TEMPLATE_SIZE);
+  hash = xhset_hash(hash, path, strlen(path) + 1);
+  hash = xhset_hash(hash, flag ? flag : "", flag ? strlen(flag) + 1 : 1);
+  hash = xhset_hash(hash, tmpl, *len);
+
+  return hash;
+}
+
+unsigned long long fbaseline_key(fstore_t *store, const finfo_t *info)
+{
+  char tmpl[FSTORE_TEMPLATE_SIZE];
+  int len = 0;
+
+  return fbaseline_hash(store, info, tmpl, &len);
+}
+
+int fbaseline_line(fstore_t *store, const finfo_t *info, char *buf, 
+                   int size, unsigned long long *key)
+{
+  const char *flag = fstore_flag(store, info);
+  char tmpl[FSTORE_TEMPLATE_SIZE];
+  int len = 0, n = 0;
+
+  *key = fbaseline_hash(store, info, tmpl, &len);
+  n = snprintf(buf, size, "%016llx %s %s %.*s\n", *key, 
+               fstore_path(store, info), flag ? flag : "-", len, tmpl);
+
+  return n < size ? n : size - 1;
+}
+
+int fbaseline_match(fbaseline_t *base, fstore_t *store, const finfo_t *info)
+{
+  int known = 0;
+
+  /* a note is known by itself or by the one it goes with, errors never */
+  if(info->type == INFO_TYPE_ERROR)
+    known = base->known = 0;
+  else if(info->type == INFO_TYPE_NOTE)
+    known = base->known || xhset_has(&base->keys, fbaseline_key(store, info));
+  else
+    known = base->known = xhset_has(&base->keys, fbaseline_key(store, info));
+
+  if(known && info->type < INFO_TYPE_MAX)
+    base->hits[info->type]++;
+  return known;
+}
@@ -0,0 +1,405 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+#include "fdb.h"
+
+#define FDB_ALIGN(len) (((len) + 3) & ~3)
+
+/* bytes of a record with its strings and padding */
+#define FDB_RECORD_LEN(path_len, flag_len, desc_len) \
+  FDB_ALIGN(sizeof(fdb_record_t) + (path_len) + (flag_len) + (desc_len) + 3)
+
+static unsigned int fdb_crc32(const void *buf, size_t len)
+{
+  static unsigned int table[256];
+  const unsigned char *p = buf;
+  unsigned int crc = 0xffffffff;
+  size_t i = 0;
+
+  if(!table[1])
+  {
+    unsigned int n = 0, k = 0, c = 0;
+    for(n = 0; n < 256; n++)
+    {
+      for(c = n, k = 0; k < 8; k++)
+        c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+  }
+
+  for(; i < len; i++)
+    crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+
+  return crc ^ 0xffffffff;
+}
+
+static int fdb_write_header(fdb_t *db)
+{
+  fdb_header_t header;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = FDB_MAGIC;
+  header.version = FDB_VERSION;
+  header.generation = db->generation;
+
+  if(pwrite(db->fd, &header, sizeof(header), 0) != sizeof(header))
+  {
+    perror("pwrite");
+    return -1;
+  }
+
+  return 0;
+}
+
+fdb_t *fdb_open(const char *path)
+{
+  fdb_header_t header;
+  struct stat st;
+  fdb_t *db = NULL;
+
+  db = malloc(sizeof(fdb_t));
+  if(!db)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(db, 0, sizeof(fdb_t));
+  snprintf(db->path, sizeof(db->path), "%s", path);
+
+  /* a symlink planted at path is not followed */
+  db->fd = open(path, O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+  if(db->fd < 0 || fstat(db->fd, &st) < 0)
+  {
+    perror(path);
+    goto err;
+  }
+
+  if(!S_ISREG(st.st_mode))
+  {
+    fprintf(stderr, "%s is not a regular file, going without it\n", path);
+    goto err;
+  }
+
+  /* a second fhelper would append to or reset the file under the first */
+  if(flock(db->fd, LOCK_EX | LOCK_NB) < 0)
+  {
+    if(errno == EWOULDBLOCK)
+      fprintf(stderr, "%s is used by another fhelper, going without it\n", 
+              path);
+    else
+      perror("flock");
+    goto err;
+  }
+
+  memset(&header, 0, sizeof(header));
+  if(st.st_size >= sizeof(header)
+     && pread(db->fd, &header, sizeof(header), 0) == sizeof(header)
+     && header.magic == FDB_MAGIC
+     && header.version == FDB_VERSION)
+  {
+    db->generation = header.generation;
+    db->end = st.st_size;
+    return db;
+  }
+
+  /* a file which is not ours is never truncated */
+  if(st.st_size && header.magic != FDB_MAGIC)
+  {
+    fprintf(stderr, "%s is not an fhelper db, going without it\n", path);
+    goto err;
+  }
+
+  /* a new file or an old version, start it over */
+  db->generation = header.generation + 1;
+  if(ftruncate(db->fd, 0) < 0 || fdb_write_header(db) < 0)
+    goto err;
+
+  db->end = sizeof(header);
+  return db;
+
+err:
+  if(db->fd >= 0)
+    close(db->fd);
+  free(db);
+  return NULL;
+}
+
+void fdb_close(fdb_t *db)
+{
+  if(!db)
+    return;
+
+  free(db->map);
+  if(db->fd >= 0)
+    close(db->fd);
+  free(db);
+}
+
+/* walk the records of a checked segment and hand them to the store */
+static int fdb_load_segment(fstore_t *store, const char *payload,
+                            const fdb_segment_t *seg)
+{
+  const char *ptr = payload;
+  const char *end = payload + seg->len;
+  unsigned int i = 0;
+
+  for(; i < seg->count; i++)
+  {
+    fdb_record_t rec;
+    finfo_t info;
+    const char *path = NULL, *flag = NULL;
+
+    if(end - ptr < sizeof(rec))
+      return -1;
+
+    memcpy(&rec, ptr, sizeof(rec));
+    path = ptr + sizeof(rec);
+    flag = path + rec.path_len + 1;
+
+    info.desc = flag + rec.flag_len + 1;
+    if(info.desc + rec.desc_len >= end)
+      return -1;
+
+    info.line = rec.line;
+    info.offset = rec.offset;
+    info.type = rec.type;
+    info.flags = 0;
+    info.path_id = xintern_add(store->paths, path, rec.path_len);
+    info.flag_id = XINTERN_NONE;
+    if(rec.flag_len)
+      info.flag_id = xintern_add(store->flags, flag, rec.flag_len);
+
+    /* no copy, desc stays in the mapping */
+    if(info.path_id == XINTERN_NONE
+       || fstore_insert(store, &info, 0) == FSTORE_NONE)
+      return -1;
+
+    ptr += FDB_RECORD_LEN(rec.path_len, rec.flag_len, rec.desc_len);
+  }
+
+  return 0;
+}
+
+int fdb_load(fdb_t *db, fstore_t *store)
+{
+  off_t offset = sizeof(fdb_header_t);
+  unsigned int first = fstore_count(store);
+  char *map = NULL;
+  size_t len = 0;
+  ssize_t n = 0;
+
+  if(db->end <= offset)
+    return 0;
+
+  map = malloc(db->end);
+  if(!map)
+  {
+    perror("malloc");
+    return -1;
+  }
+
+  /* a file which got shorter since the open ends where the read did */
+  while(len < db->end)
+  {
+    n = pread(db->fd, map + len, db->end - len, len);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n <= 0)
+      break;
+    len += n;
+  }
+  db->end = len;
+
+  db->map = map;
+  db->map_size = db->end;
+
+  while(offset + sizeof(fdb_segment_t) <= db->end)
+  {
+    fdb_segment_t seg;
+    const char *payload = map + offset + sizeof(seg);
+
+    memcpy(&seg, map + offset, sizeof(seg));
+    if(seg.magic != FDB_SEG_MAGIC
+       || seg.generation != db->generation
+       || seg.len > db->end - offset - sizeof(seg)
+       || fdb_crc32(payload, seg.len) != seg.crc)
+      break;
+
+    if(fdb_load_segment(store, payload, &seg) < 0)
+      break;
+
+    offset += sizeof(seg) + seg.len;
+  }
+
+  /* cut the torn or stale tail, new segments are appended after it */
+  if(offset < db->end)
+  {
+    if(ftruncate(db->fd, offset) < 0)
+      perror("ftruncate");
+    db->end = offset;
+  }
+
+  if(fstore_count(store) == first)
+  {
+    free(db->map);
+    db->map = NULL;
+    db->map_size = 0;
+  }
+
+  return fstore_count(store) - first;
+}
+
+int fdb_append(fdb_t *db, fstore_t *store, unsigned int from, unsigned int to)
+{
+  fdb_segment_t seg;
+  size_t len = 0;
+  unsigned int i = 0;
+  char *buf = NULL, *ptr = NULL;
+  int ret = -1;
+
+  if(from >= to)
+    return 0;
+
+  for(i = from; i < to; i++)
+  {
+    finfo_t *info = fstore_row(store, i);
+    const char *flag = fstore_flag(store, info);
+
+    if(info->flags & (FINFO_DEAD | FINFO_VOLATILE))
+      continue;
+
+    len += FDB_RECORD_LEN(strlen(fstore_path(store, info)),
+                          flag ? strlen(flag) : 0, strlen(info->desc));
+  }
+
+  buf = malloc(sizeof(seg) + len);
+  if(!buf)
+  {
+    perror("malloc");
+    return -1;
+  }
+
+  ptr = buf + sizeof(seg);
+  for(i = from; i < to; i++)
+  {
+    finfo_t *info = fstore_row(store, i);
+    const char *path = fstore_path(store, info);
+    const char *flag = fstore_flag(store, info);
+    fdb_record_t rec;
+
+    if(info->flags & (FINFO_DEAD | FINFO_VOLATILE))
+      continue;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.line = info->line;
+    rec.offset = info->offset;
+    rec.type = info->type;
+    rec.path_len = strlen(path);
+    rec.flag_len = flag ? strlen(flag) : 0;
+    rec.desc_len = strlen(info->desc);
+
+    memset(ptr, 0, FDB_RECORD_LEN(rec.path_len, rec.flag_len, rec.desc_len));
+    memcpy(ptr, &rec, sizeof(rec));
+    memcpy(ptr + sizeof(rec), path, rec.path_len);
+    memcpy(ptr + sizeof(rec) + rec.path_len + 1, flag ? flag : "", rec.flag_len);
+    memcpy(ptr + sizeof(rec) + rec.path_len + rec.flag_len + 2, 
+           info->desc, rec.desc_len);
+    ptr += FDB_RECORD_LEN(rec.path_len, rec.flag_len, rec.desc_len);
+  }
+
+  memset(&seg, 0, sizeof(seg));
+  seg.magic = FDB_SEG_MAGIC;
+  seg.count = 0;
+  for(i = from; i < to; i++)
+    seg.count += !(fstore_row(store, i)->flags 
+                   & (FINFO_DEAD | FINFO_VOLATILE));
+  seg.len = len;
+  seg.crc = fdb_crc32(buf + sizeof(seg), len);
+  seg.generation = db->generation;
+  memcpy(buf, &seg, sizeof(seg));
+
+  /* one write per segment, a partial one fails the crc at load time */
+  if(pwrite(db->fd, buf, sizeof(seg) + len, db->end) == sizeof(seg) + len)
+  {
+    db->end += sizeof(seg) + len;
+    ret = 0;
+  }
+  else
+  {
+    perror("pwrite");
+    if(ftruncate(db->fd, db->end) < 0)
+      perror("ftruncate");
+  }
+
+  free(buf);
+  return ret;
+}
+
+int fdb_reset(fdb_t *db)
+{
+  if(!db)
+    return -1;
+
+  free(db->map);
+  db->map = NULL;
+  db->map_size = 0;
+
+  /* the header goes first, old segments are stale even if truncate fails */
+  db->generation++;
+  if(fdb_write_header(db) < 0)
+    return -1;
+
+  db->end = sizeof(fdb_header_t);
+  if(ftruncate(db->fd, db->end) < 0)
+  {
+    perror("ftruncate");
+    return -1;
+  }
+
+  return 0;
+}
+
+int fdb_compact(fdb_t *db, fstore_t *store)
+{
+  /* the buffer of the loaded rows is not the file, it outlives it */
+  db->generation++;
+  if(fdb_write_header(db) < 0)
+    return -1;
+
+  db->end = sizeof(fdb_header_t);
+  if(ftruncate(db->fd, db->end) < 0)
+  {
+    perror("ftruncate");
+    return -1;
+  }
+
+  return fdb_append(db, store, 0, fstore_count(store));
+}
@@ -0,0 +1,235 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "femit.h"
+#include "xwidth.h"
+
+static const char *format_names[FEMIT_MAX] =
+{
+  "plain", "quickfix", "jsonl", "baseline",
+};
+
+femit_format_t femit_format_get(const char *name)
+{
+  int i = 0;
+
+  for(; name && i < FEMIT_MAX; i++)
+  {
+    if(!strcmp(name, format_names[i]))
+      return i;
+  }
+
+  return FEMIT_MAX;
+}
+
+femit_t *femit_create(femit_format_t format, fstore_t *store, int fd)
+{
+  femit_t *emit = malloc(sizeof(femit_t));
+  if(!emit)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(emit, 0, sizeof(femit_t));
+  if(xwriter_init(&emit->out, fd, XWRITER_SIZE) < 0)
+  {
+    free(emit);
+    return NULL;
+  }
+
+  emit->format = format;
+  emit->store = store;
+  xhset_init(&emit->seen);
+
+  return emit;
+}
+
+void femit_destroy(femit_t *emit)
+{
+  if(!emit)
+    return;
+
+  xwriter_flush(&emit->out);
+  xwriter_release(&emit->out);
+  xhset_release(&emit->seen);
+  free(emit);
+}
+
+int femit_flush(femit_t *emit)
+{
+  return xwriter_flush(&emit->out);
+}
+
+/* the length of desc without its trailing [-Wxxx] */
+static size_t femit_message_len(const finfo_t *info)
+{
+  size_t len = strlen(info->desc);
+  const char *open = NULL;
+
+  if(info->flag_id == XINTERN_NONE)
+    return len;
+
+  open = strrchr(info->desc, '[');
+  if(open)
+    len = open - info->desc;
+  while(len && info->desc[len - 1] == ' ')
+    len--;
+
+  return len;
+}
+
+/* 
+ * str as a json string, valid utf-8 is left as it is and each byte which
+ * is not part of a character becomes U+FFFD
+ */
+static void femit_json_str(xwriter_t *out, const char *str, size_t len)
+{
+  size_t i = 0, run = 0;
+
+  xwriter_putc(out, '"');
+  for(; i < len; i++)
+  {
+    unsigned char c = str[i];
+    int n = 0, cols = 0;
+
+    if(c >= 0x20 && c < 0x7f && c != '"' && c != '\\')
+      continue;
+
+    /* a whole utf-8 character goes as it is, a broken byte is replaced */
+    if(c >= 0x80 && (n = xwidth_next(str + i, len - i, &cols)) > 1)
+    {
+      i += n - 1;
+      continue;
+    }
+
+    /* the plain bytes before c go out in one piece */
+    xwriter_write(out, str + run, i - run);
+    run = i + 1;
+
+    if(c == '"' || c == '\\')
+    {
+      xwriter_putc(out, '\\');
+      xwriter_putc(out, c);
+    }
+    else if(c == '\t')
+      xwriter_write(out, "\\t", 2);
+    else if(c >= 0x80)
+      xwriter_write(out, "\\ufffd", 6);
+    else
+      xwriter_printf(out, "\\u%04x", c);
+  }
+
+  xwriter_write(out, str + run, len - run);
+  xwriter_putc(out, '"');
+}
+
+/* the notes go with their error or warning, they are left out */
+static int femit_baseline(femit_t *emit, const finfo_t *info)
+{
+  char line[FSTORE_TEMPLATE_SIZE + PATH_MAX];
+  unsigned long long key = 0;
+  int len = 0, ret = 0;
+
+  /* only warnings may be known, errors always show */
+  if(info->type != INFO_TYPE_WARN)
+    return 0;
+
+  len = fbaseline_line(emit->store, info, line, sizeof(line), &key);
+  ret = xhset_add(&emit->seen, key);
+  if(ret <= 0)
+  {
+    emit->dups += !ret;
+    return ret;
+  }
+
+  xwriter_write(&emit->out, line, len);
+  emit->rows++;
+  return emit->out.error ? -1 : 1;
+}
+
+int femit_row(femit_t *emit, const finfo_t *info)
+{
+  fstore_t *store = emit->store;
+  const char *path = fstore_path(store, info);
+  const char *flag = fstore_flag(store, info);
+  size_t len = femit_message_len(info);
+  unsigned long long hash = XHSET_SEED;
+  int ret = 0;
+
+  if(emit->format == FEMIT_BASELINE)
+    return femit_baseline(emit, info);
+
+  if(emit->known && fbaseline_match(emit->known, store, info))
+    return 0;
+
+  /* path and flag ids are fixed for the run, the rest is the row itself */
+  hash = xhset_hash(hash, &info->path_id, sizeof(info->path_id));
+  hash = xhset_hash(hash, &info->flag_id, sizeof(info->flag_id));
+  hash = xhset_hash(hash, &info->line, sizeof(info->line));
+  hash = xhset_hash(hash, &info->offset, sizeof(info->offset));
+  hash = xhset_hash(hash, &info->type, sizeof(info->type));
+  hash = xhset_hash(hash, info->desc, len);
+
+  ret = xhset_add(&emit->seen, hash);
+  if(ret <= 0)
+  {
+    emit->dups += !ret;
+    return ret;
+  }
+
+  switch(emit->format)
+  {
+    case FEMIT_QUICKFIX:
+      xwriter_printf(&emit->out, "%s:%u:%u:%c:%.*s\n", path, info->line, 
+                     info->offset, "EWNU"[info->type], (int)len, info->desc);
+      break;
+    case FEMIT_JSONL:
+      xwriter_write(&emit->out, "{\"file\":", 8);
+      femit_json_str(&emit->out, path, strlen(path));
+      xwriter_printf(&emit->out, ",\"line\":%u,\"column\":%u,\"severity\":\"%s\"",
+                     info->line, info->offset, info_type_name(info->type));
+      xwriter_write(&emit->out, ",\"flag\":", 8);
+      if(flag)
+        femit_json_str(&emit->out, flag, strlen(flag));
+      else
+        xwriter_write(&emit->out, "null", 4);
+      xwriter_write(&emit->out, ",\"message\":", 11);
+      femit_json_str(&emit->out, info->desc, len);
+      xwriter_write(&emit->out, "}\n", 2);
+      break;
+    case FEMIT_PLAIN:
+    default:
+      xwriter_printf(&emit->out, "%s:%u:%u: %s: %.*s%s%s%s\n", path, 
+                     info->line, info->offset, info_type_name(info->type),
+                     (int)len, info->desc, flag ? " [" : "", flag ? flag : "",
+                     flag ? "]" : "");
+      break;
+  }
+
+  emit->rows++;
+  return emit->out.error ? -1 : 1;
+}
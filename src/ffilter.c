@@ -0,0 +1,508 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fnmatch.h>
+
+#include "ffilter.h"
+
+/* sort the passing rows if they are under 1/FFILTER_SPARSE of the index */
+#define FFILTER_SPARSE 4
+
+ffilter_t *ffilter_create(fstore_t *store, fsort_t sort)
+{
+  ffilter_t *filter = malloc(sizeof(ffilter_t));
+  if(!filter)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(filter, 0, sizeof(ffilter_t));
+  filter->store = store;
+  filter->next = fstore_count(store);
+  filter->subset = fstore_subset_create(store, sort);
+  if(!filter->subset)
+  {
+    free(filter);
+    return NULL;
+  }
+
+  return filter;
+}
+
+void ffilter_destroy(ffilter_t *filter)
+{
+  int i = 0;
+
+  if(!filter)
+    return;
+
+  for(; i < filter->count; i++)
+  {
+    free(filter->terms[i].pattern);
+    free(filter->terms[i].cache);
+    xbitset_release(&filter->terms[i].rows);
+  }
+
+  fstore_subset_destroy(filter->store, filter->subset);
+  xbitset_release(&filter->bits);
+  xbitset_release(&filter->any);
+  free(filter->ids);
+  free(filter);
+}
+
+/* a directory is matched at the start of the path or after a '/' */
+static int ffilter_dir_match(const char *path, const char *dir)
+{
+  size_t len = strlen(dir);
+  const char *ptr = path;
+
+  if(!strncmp(path, dir, len))
+    return 1;
+
+  while((ptr = strchr(ptr, '/')))
+  {
+    ptr++;
+    if(!strncmp(ptr, dir, len))
+      return 1;
+  }
+
+  return 0;
+}
+
+/* flags and paths are matched once for all the rows which have them */
+static int ffilter_cached(ffilter_term_t *term, fstore_t *store, 
+                          unsigned int id)
+{
+  if(id >= term->cache_size)
+  {
+    unsigned int size = term->cache_size ? term->cache_size : 64;
+    signed char *cache = NULL;
+
+    while(size <= id)
+      size *= 2;
+
+    cache = realloc(term->cache, size);
+    if(!cache)
+    {
+      perror("realloc");
+      return 0;
+    }
+
+    memset(cache + term->cache_size, -1, size - term->cache_size);
+    term->cache = cache;
+    term->cache_size = size;
+  }
+
+  if(term->cache[id] < 0)
+  {
+    if(term->kind == FFILTER_FLAG)
+      term->cache[id] = !fnmatch(term->pattern, 
+                                 xintern_str(store->flags, id), 0);
+    else
+      term->cache[id] = ffilter_dir_match(xintern_str(store->paths, id), 
+                                          term->pattern);
+  }
+
+  return term->cache[id];
+}
+
+static int ffilter_match(ffilter_term_t *term, fstore_t *store, 
+                         const finfo_t *row)
+{
+  switch(term->kind)
+  {
+    case FFILTER_SEVERITY:
+      return row->type == term->value;
+    case FFILTER_FLAG:
+      return row->flag_id != XINTERN_NONE 
+             && ffilter_cached(term, store, row->flag_id);
+    case FFILTER_DIR:
+      return ffilter_cached(term, store, row->path_id);
+    case FFILTER_TEMPLATE:
+      /* looked up again once the template came back after a flush */
+      if(term->value == XINTERN_NONE)
+        term->value = xintern_find(store->templates, term->pattern, -1);
+      return term->value != XINTERN_NONE && row->tmpl_id == term->value;
+    case FFILTER_KNOWN:
+      return (row->flags & FINFO_KNOWN) != 0;
+    default:
+      return 0;
+  }
+}
+
+/* add the rows [from, to) to the bitset of term */
+static void ffilter_fill(ffilter_t *filter, ffilter_term_t *term,
+                         unsigned int from, unsigned int to)
+{
+  fstore_t *store = filter->store;
+
+  for(; from < to; from++)
+  {
+    const finfo_t *row = fstore_row(store, from);
+
+    if(!(row->flags & FINFO_DEAD) && ffilter_match(term, store, row))
+      xbitset_set(&term->rows, from);
+  }
+}
+
+/* parse term into kind, hide and pattern, return -1 if it is bad */
+static int ffilter_parse(ffilter_term_t *term, const char *str,
+                         unsigned int tmpl_id, fstore_t *store)
+{
+  int type = 0;
+
+  memset(term, 0, sizeof(ffilter_term_t));
+  if(*str == '!')
+  {
+    term->hide = 1;
+    str++;
+  }
+
+  if(!*str)
+    return -1;
+
+  for(type = 0; type < INFO_TYPE_UNKNOWN; type++)
+  {
+    if(!strcmp(str, info_type_name(type)))
+    {
+      term->kind = FFILTER_SEVERITY;
+      term->value = type;
+      term->pattern = strdup(str);
+      return term->pattern ? 0 : -1;
+    }
+  }
+
+  if(!strncmp(str, "-W", 2))
+  {
+    term->kind = FFILTER_FLAG;
+    term->pattern = strdup(str);
+  }
+  else if(!strcmp(str, "known"))
+  {
+    term->kind = FFILTER_KNOWN;
+    term->pattern = strdup(str);
+  }
+  else if(!strcmp(str, "~"))
+  {
+    if(tmpl_id == XINTERN_NONE)
+      return -1;
+
+    term->kind = FFILTER_TEMPLATE;
+    term->value = tmpl_id;
+    term->pattern = strdup(xintern_str(store->templates, tmpl_id));
+  }
+  else
+  {
+    /* anything else is a directory */
+    size_t len = strlen(str);
+
+    term->kind = FFILTER_DIR;
+    term->pattern = malloc(len + 2);
+    if(term->pattern)
+      snprintf(term->pattern, len + 2, "%s%s", str, 
+               str[len - 1] == '/' ? "" : "/");
+  }
+
+  return term->pattern ? 0 : -1;
+}
+
+int ffilter_toggle(ffilter_t *filter, const char *str, unsigned int tmpl_id)
+{
+  ffilter_term_t term, *old = NULL;
+  int i = 0;
+
+  if(ffilter_parse(&term, str, tmpl_id, filter->store) < 0)
+  {
+    free(term.pattern);
+    return -1;
+  }
+
+  for(; i < filter->count; i++)
+  {
+    old = &filter->terms[i];
+    if(old->kind == term.kind && old->hide == term.hide
+       && !strcmp(old->pattern, term.pattern))
+    {
+      free(term.pattern);
+      old->on = !old->on;
+      return old->on;
+    }
+  }
+
+  /* a new one, the oldest term which is off makes room */
+  if(filter->count == FFILTER_MAX_TERMS)
+  {
+    for(i = 0; i < filter->count && filter->terms[i].on; i++)
+      ;
+
+    if(i == filter->count)
+    {
+      free(term.pattern);
+      return -1;
+    }
+
+    old = &filter->terms[i];
+    free(old->pattern);
+    free(old->cache);
+    xbitset_release(&old->rows);
+    memmove(old, old + 1, (filter->count - i - 1) * sizeof(ffilter_term_t));
+    filter->count--;
+  }
+
+  term.on = 1;
+  filter->terms[filter->count] = term;
+  ffilter_fill(filter, &filter->terms[filter->count], 0, filter->next);
+  filter->count++;
+
+  return 1;
+}
+
+void ffilter_clear(ffilter_t *filter)
+{
+  int i = 0;
+
+  for(; i < filter->count; i++)
+    filter->terms[i].on = 0;
+}
+
+int ffilter_active(ffilter_t *filter)
+{
+  int i = 0;
+
+  for(; i < filter->count; i++)
+  {
+    if(filter->terms[i].on)
+      return 1;
+  }
+
+  return 0;
+}
+
+/* the terms keeping rows of a kind add up, the kinds narrow each other */
+static int ffilter_pass(ffilter_t *filter, unsigned int id)
+{
+  int kind = 0, i = 0;
+
+  for(; kind < FFILTER_KINDS; kind++)
+  {
+    int keep = 0, in = 0;
+
+    for(i = 0; i < filter->count; i++)
+    {
+      ffilter_term_t *term = &filter->terms[i];
+
+      if(!term->on || term->hide || term->kind != kind)
+        continue;
+
+      keep = 1;
+      in |= xbitset_test(&term->rows, id);
+    }
+
+    if(keep && !in)
+      return 0;
+  }
+
+  for(i = 0; i < filter->count; i++)
+  {
+    ffilter_term_t *term = &filter->terms[i];
+
+    if(term->on && term->hide && xbitset_test(&term->rows, id))
+      return 0;
+  }
+
+  return 1;
+}
+
+/* the same as ffilter_pass() for every row at once, a word at a time */
+static int ffilter_eval(ffilter_t *filter)
+{
+  int kind = 0, i = 0;
+
+  if(xbitset_copy(&filter->bits, &filter->store->alive) < 0)
+    return -1;
+
+  for(; kind < FFILTER_KINDS; kind++)
+  {
+    int keep = 0;
+
+    xbitset_zero(&filter->any);
+    for(i = 0; i < filter->count; i++)
+    {
+      ffilter_term_t *term = &filter->terms[i];
+
+      if(!term->on || term->hide || term->kind != kind)
+        continue;
+
+      keep = 1;
+      if(xbitset_or(&filter->any, &term->rows) < 0)
+        return -1;
+    }
+
+    if(keep)
+      xbitset_and(&filter->bits, &filter->any);
+  }
+
+  for(i = 0; i < filter->count; i++)
+  {
+    ffilter_term_t *term = &filter->terms[i];
+
+    if(term->on && term->hide)
+      xbitset_andnot(&filter->bits, &term->rows);
+  }
+
+  return 0;
+}
+
+/* bring the bitsets up to date, return the first new row */
+static unsigned int ffilter_catch_up(ffilter_t *filter)
+{
+  fstore_t *store = filter->store;
+  unsigned int from = filter->next;
+  int i = 0;
+
+  /* the store was flushed, the ids start over */
+  if(from > fstore_count(store))
+  {
+    from = 0;
+    for(i = 0; i < filter->count; i++)
+    {
+      ffilter_term_t *term = &filter->terms[i];
+
+      xbitset_zero(&term->rows);
+      if(term->cache)
+        memset(term->cache, -1, term->cache_size);
+      if(term->kind == FFILTER_TEMPLATE)
+        term->value = XINTERN_NONE;
+    }
+  }
+
+  for(i = 0; i < filter->count; i++)
+    ffilter_fill(filter, &filter->terms[i], from, fstore_count(store));
+
+  filter->next = fstore_count(store);
+  return from;
+}
+
+int ffilter_apply(ffilter_t *filter, xskiplist_t *within)
+{
+  fstore_t *store = filter->store;
+  fsort_t sort = fstore_index_sort(store, filter->subset);
+  xskiplist_t *index = within ? within : fstore_index(store, sort);
+  xsknode_t *node = NULL;
+  unsigned int count = 0, size = 0;
+  long id = 0;
+
+  ffilter_catch_up(filter);
+  if(ffilter_eval(filter) < 0)
+    return -1;
+
+  size = xbitset_count(&filter->bits);
+  if(filter->ids_size < size)
+  {
+    unsigned int *ids = realloc(filter->ids, size * sizeof(unsigned int));
+    if(!ids)
+    {
+      perror("realloc");
+      return -1;
+    }
+
+    filter->ids = ids;
+    filter->ids_size = size;
+  }
+
+  /* 
+   * a few rows are cheaper to sort than walking every node of a big index,
+   * the bits give them by id which is nearly the order of the arrival sorts
+   */
+  if(!within && size * FFILTER_SPARSE < xskiplist_count(index))
+  {
+    while((id = xbitset_next(&filter->bits, id)) >= 0)
+      filter->ids[count++] = id++;
+
+    if(fstore_sort_ids(store, sort, filter->ids, count) < 0)
+      return -1;
+
+    return xskiplist_build(filter->subset, filter->ids, count);
+  }
+
+  /* the index is in the order already, the subset is built in one go */
+  for(node = xskiplist_first(index); node; node = xskiplist_next(node))
+  {
+    if(xbitset_test(&filter->bits, node->id))
+      filter->ids[count++] = node->id;
+  }
+
+  return xskiplist_build(filter->subset, filter->ids, count);
+}
+
+void ffilter_update(ffilter_t *filter, xskiplist_t *within)
+{
+  fstore_t *store = filter->store;
+  unsigned int id = ffilter_catch_up(filter);
+
+  for(; ffilter_active(filter) && id < fstore_count(store); id++)
+  {
+    if(!xbitset_test(&store->alive, id) || !ffilter_pass(filter, id))
+      continue;
+
+    if(!within || xskiplist_rank(within, id) >= 0)
+      xskiplist_insert(filter->subset, id);
+  }
+}
+
+int ffilter_describe(ffilter_t *filter, char *buf, int size)
+{
+  int len = 0, i = 0;
+
+  buf[0] = '\0';
+  for(; i < filter->count && len < size; i++)
+  {
+    ffilter_term_t *term = &filter->terms[i];
+
+    if(!term->on)
+      continue;
+
+    len += snprintf(buf + len, size - len, "%s%s%s%s", len ? " " : "",
+                    term->hide ? "!" : "", 
+                    term->kind == FFILTER_TEMPLATE ? "~" : "",
+                    term->pattern);
+  }
+
+  return len < size ? len : size - 1;
+}
+
+size_t ffilter_bytes(ffilter_t *filter)
+{
+  size_t bytes = sizeof(ffilter_t);
+  int i = 0;
+
+  for(; i < filter->count; i++)
+    bytes += xbitset_bytes(&filter->terms[i].rows) + filter->terms[i].cache_size;
+
+  bytes += xbitset_bytes(&filter->bits) + xbitset_bytes(&filter->any);
+  bytes += filter->ids_size * sizeof(unsigned int);
+
+  return bytes;
+}
@@ -27,13 +27,15 @@
 #include <signal.h>
 #include <errno.h>
 #include <getopt.h>
-#include <sys/ioctl.h>
 
 /* for mkfifo */
 #include <sys/types.h>
 #include <sys/stat.h>
 /* for file open */
 #include <fcntl.h>
+#include <time.h>
+#include <limits.h>
+#include <stdint.h>
 
 /* see /usr/include/unistd.h 
  * Standard file descriptors.
@@ -44,11 +46,28 @@
 
 #include "xdebug.h"
 #include "xarray.h"
-#include "xqueue.h"
+#include "fstore.h"
+#include "flayout.h"
+#include "fview.h"
+#include "fsearch.h"
+#include "ffilter.h"
+#include "fdb.h"
+#include "xfcache.h"
+#include "xlines.h"
+#include "xwidth.h"
+#include "femit.h"
+#include "fnotes.h"
+#include "fbaseline.h"
+#include "frules.h"
+#include "xscreen.h"
 #include "terminal.h"
 
-#define RECV_BUFSIZE 1024
 #define FHELPER_PIPE "/tmp/fhelper"
+#define FHELPER_DB   "fhelper.db"  /* under $XDG_RUNTIME_DIR, or ~/. */
+
+/* the source files kept for the preview */
+#define PREVIEW_FILES 32
+#define PREVIEW_BYTES (512 * 1024 * 1024)
 
 static int fhelper_pipe_create()
 {
@@ -121,6 +140,105 @@ ssize_t safe_read(int fd, void *buf, size_t count)
 }
 
 static int g_auto_refresh = 1;
+
+/* 0 means no limit */
+static size_t g_max_mem = 0;
+
+/* notes kept after an error or a warning, the others are spooled */
+static unsigned int g_max_notes = FNOTES_BUDGET;
+
+/* redraws are coalesced to at most g_fps frames a second */
+static int g_fps = 30;
+
+/* frames skipped because the terminal had not taken the last ones */
+static unsigned long g_dropped = 0;
+
+static unsigned long long fhelper_now_us()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* 
+ * "256M" to *size in bytes, K/M/G suffixes are supported. return -1 if
+ * str is not a number, has another suffix or is too big
+ */
+static int fhelper_parse_size(const char *str, size_t *size)
+{
+  char *end = NULL;
+  unsigned long long value = 0;
+  int shift = 0;
+
+  errno = 0;
+  value = strtoull(str, &end, 10);
+  if(end == str || errno == ERANGE || strchr(str, '-'))
+    return -1;
+
+  /* a suffix falls through to the smaller ones, a G shifts 3 times 10 */
+  switch(toupper((unsigned char)*end))
+  {
+    case 'G':
+      shift += 10;
+      /* fall through */
+    case 'M':
+      shift += 10;
+      /* fall through */
+    case 'K':
+      shift += 10;
+      end++;
+      break;
+    case '\0':
+      break;
+    default:
+      return -1;
+  }
+
+  if(*end || value > (SIZE_MAX >> shift))
+    return -1;
+
+  *size = value << shift;
+  return 0;
+}
+
+/* the default db of the user, NULL if there is no place for it */
+static const char *fhelper_db_path(char *buf, size_t size)
+{
+  const char *dir = getenv("XDG_RUNTIME_DIR");
+
+  if(dir && *dir)
+  {
+    snprintf(buf, size, "%s/" FHELPER_DB, dir);
+    return buf;
+  }
+
+  dir = getenv("HOME");
+  if(dir && *dir)
+  {
+    snprintf(buf, size, "%s/." FHELPER_DB, dir);
+    return buf;
+  }
+
+  return NULL;
+}
+
+/* human readable size, buf should be at least 16 bytes */
+static const char *fhelper_size_str(size_t size, char *buf)
+{
+  static const char units[] = "BKMG";
+  double value = size;
+  int unit = 0;
+
+  while(value >= 1024 && unit < sizeof(units) - 2)
+  {
+    value /= 1024;
+    unit++;
+  }
+
+  sprintf(buf, unit ? "%.1f%c" : "%.0f%c", value, units[unit]);
+  return buf;
+}
 #if 0
 static void auto_refresh_set(int yes)
 {
@@ -161,15 +279,58 @@ static void usage(void)
           "where options may include:\n"
           "\n"
           "  --help -h        to output this message.\n"
+          "  --db -b <file>   keep diagnostics in file, default\n"
+          "                   $XDG_RUNTIME_DIR/" FHELPER_DB " or ~/." FHELPER_DB ".\n"
+          "  --nodb -n        don't keep diagnostics across restarts.\n"
+          "  --max-mem -m <n> memory budget like 256M, notes are evicted\n"
+          "                   first, then warnings, errors are kept. an\n"
+          "                   evicted row still takes about 60 bytes.\n"
+          "  --max-notes -N <n>\n"
+          "                   keep n notes after an error or a warning, the\n"
+          "                   others are counted under one row, x shows\n"
+          "                   them. default %u, 0 keeps them all.\n"
+          "  --fps -f <n>     redraw at most n times a second, default 30.\n"
+          "  --emit -e <fmt>  no screen, read the build output from stdin and\n"
+          "                   write each diagnostic once as soon as it is\n"
+          "                   parsed: plain, jsonl, quickfix (for vim,\n"
+          "                   :set efm=%%f:%%l:%%c:%%t:%%m) or baseline.\n"
+          "  --output -o <f>  write --emit to file f, default stdout.\n"
+          "  --rules -r <f>   classify by the rules in f, a line each like\n"
+          "                   note path:vendor/, ignore path:tests/\n"
+          "                   flag:-Wdeprecated* or error message:\"ODR\n"
+          "                   violation\". the first rule matching wins.\n"
+          "  --baseline -B <f>\n"
+          "                   hide the warnings listed in f and their\n"
+          "                   notes, :!known shows them again. errors always\n"
+          "                   show. make a new one with --emit baseline -o f.\n"
           "  D or d           refresh the screen.\n"
           "  S or s           enable or disable refresh .\n"
-          "  Arrows/pagedn/up scroll the list.\n"
+          "  O or o           switch order: default/file/severity/flag.\n"
+          "  E or e           jump to the next error.\n"
+          "  F or f           jump to the next file.\n"
+          "  0-9              jump to 0%%-90%% of the list.\n"
+          "  P or p           show the source around the top row under the\n"
+          "                   list, the files of new errors are read ahead.\n"
+          "  T or t           show the directories with their counts, right\n"
+          "                   and left open and close one, Enter toggles it\n"
+          "                   in the filter and shows its rows.\n"
+          "  /                search the descriptions as you type, from 3\n"
+          "                   characters on, ignoring the case unless there\n"
+          "                   is an upper case letter.\n"
+          "  :                toggle filter terms, Enter with none clears them:\n"
+          "                   error/warning/note, -Wflag or -Wglob-*, a dir/,\n"
+          "                   ~ the kind of the top row, known the baseline\n"
+          "                   ones. !term hides its rows.\n"
+          "                   Enter keeps the matches shown, ESC drops them.\n"
+          "  Arrows/pagedn/up scroll the list, so does the mouse wheel,\n"
+          "                   home/end go to the ends, end follows new rows.\n"
+          "  X or x           show the notes counted under the top row.\n"
           "  Q or q           quit.\n"
           
-          );
+          , FNOTES_BUDGET);
 }
 
-/* need to free the returned string */
+/* need to free the returned string, path_table calls it once per path */
 static char *fhelper_shrink_path(const char *path)
 {
   int i = 0;
@@ -191,281 +352,1049 @@ static char *fhelper_shrink_path(const char *path)
   return newpath;
 }
 
-/* It is perfectly ok to pass in a NULL for either width or for
- * height, in which case that value will not be set.  */
-int get_terminal_width_height(int fd, int *width, int *height)
-{
-  struct winsize win = { 0, 0, 0, 0 };
-  int ret = ioctl(fd, TIOCGWINSZ, &win);
-  
-  if (height)
-  {
-    if (!win.ws_row) 
-    {
-      char *s = getenv("LINES");
-      if (s) win.ws_row = atoi(s);
-    }
-    if (win.ws_row <= 1 || win.ws_row >= 30000)
-      win.ws_row = 24;
-    *height = (int) win.ws_row;
-  }
-  
-  if (width) 
-  {
-    if (!win.ws_col) 
-    {
-      char *s = getenv("COLUMNS");
-      if (s) win.ws_col = atoi(s);
-    }
-    if (win.ws_col <= 1 || win.ws_col >= 30000)
-            win.ws_col = 80;
-    *width = (int) win.ws_col;
-  }
-  
-  return ret;
-}
+/* frames are composed here, only the changed lines reach the terminal */
+static xscreen_t *screen = NULL;
 
-typedef enum
+/* str padded to align columns, wide characters count as 2 */
+static void info_type_printstr(info_type_t type, int align, const char *str)
 {
-  INFO_TYPE_ERROR,
-  INFO_TYPE_WARN,
-  INFO_TYPE_NOTE,
-  
-  INFO_TYPE_UNKNOWN,
-}info_type_t;
+  const xcolor_t *color = &xcolor_green_bold;
+  int pad = 0;
 
-static info_type_t info_type_get(const char *typestr)
-{
-  if(!typestr)
-    return INFO_TYPE_UNKNOWN;
+  if(align)
+    pad = align - (int)xwidth_str(str);
+  if(pad < 0)
+    pad = 0;
 
-#define TYPE_ERROR_STR  "error"
-#define TYPE_WARN_STR   "warning"
-#define TYPE_NOTE_STR   "note"
-  
-  if(strstr(typestr, TYPE_ERROR_STR))
-    return INFO_TYPE_ERROR;
-  
-  if(strstr(typestr, TYPE_WARN_STR))
-    return INFO_TYPE_WARN;
-  
-  if(strstr(typestr, TYPE_NOTE_STR))
-    return INFO_TYPE_NOTE;
-  
-  return INFO_TYPE_UNKNOWN;
+  switch(type)
+  {
+    case INFO_TYPE_ERROR:
+      color = &xcolor_red_bold;
+      break;
+    case INFO_TYPE_WARN:
+      color = &xcolor_yellow_bold;
+      break;
+    case INFO_TYPE_NOTE:
+    default:
+      break;            
+  }
+
+  xscreen_printf(screen, color, "%s%*s", str, pad, "");
 }
 
-static void info_type_printstr(info_type_t type, int align, const char *str)
+/* print len bytes of str, no copy */
+static void info_type_printn(info_type_t type, const char *str, int len)
 {
-  char fstr[16] = "%s";
-  if(align)
-    sprintf(fstr, "%%-%ds", align);
-  
   switch(type)
   {
     case INFO_TYPE_ERROR:
-      xwprintf(fstr, str);
+      xscreen_printf(screen, &xcolor_red_bold, "%.*s", len, str);
       break;
     case INFO_TYPE_WARN:
-      xnprintf(fstr, str);
+      xscreen_printf(screen, &xcolor_yellow_bold, "%.*s", len, str);
       break;
     case INFO_TYPE_NOTE:
     default:
-      xiprintf(fstr, str);
+      xscreen_printf(screen, &xcolor_green_bold, "%.*s", len, str);
       break;            
   }
 }
 
-xqueue_t *err_queue = NULL, *other_queue = NULL;
-
-/* sure the fist entry of errors is path, shrink it */
-#define PATH_INDEX       0
-#define LINE_NUM_INDEX   1
-#define OFFSET_NUM_INDEX 2
-#define INFO_TYPE_INDEX  3
-#define INFO_DESC_INDEX  4
-static void dump_infos(void *in)
+/* 
+ * str in a column of cols, clipped so a space is left after it and never
+ * in the middle of a character, then padded
+ */
+static void info_type_printcol(info_type_t type, int cols, const char *str)
 {
-  xarray_t *errors = (xarray_t *)in;
-  if(!errors)
-    return;
+  size_t used = 0;
+  size_t len = xwidth_fit(str, strlen(str), cols - 1, &used);
 
-  const char *path = (char *)xarray_get(errors, PATH_INDEX);
-  
-  char *newpath = fhelper_shrink_path(path);
-  int lines = 0, col = 0;
-  int aligned = 50;
-  
-  get_terminal_width_height(1, &col, &lines);
+  info_type_printn(type, str, len);
+  xscreen_printf(screen, NULL, "%*s", cols - (int)used, "");
+}
+
+/* all diagnostics, views are the sort indexes of the store */
+static fstore_t *store = NULL;
+
+/* the notes over the budget, NULL if there is no spool */
+static fnotes_t *notes = NULL;
+
+/* the accepted diagnostics, they are counted and not stored */
+static fbaseline_t *known = NULL;
+
+/* the local rules which change the severity of rows or drop them */
+static frules_t *rules = NULL;
+
+/* the rows on screen, a rank in the current sort index */
+static fview_t view;
+
+/* the '/' search and the ':' filter terms, NULL if there are none */
+static fsearch_t *search = NULL;
+static ffilter_t *filter = NULL;
+
+/* '/' or ':' while its line is typed */
+static char g_typing = 0;
+static char g_line[FSEARCH_MAX] = "";
+static int g_line_len = 0;
+
+/* 't' lists the directories with their counts instead of the rows */
+static int g_tree = 0;
+static unsigned int g_tree_node = FTREE_NONE; /* the selected directory */
+static unsigned int g_tree_top = 0;           /* the first listed row shown */
+static int g_tree_page = 1;
+
+/* 'p' shows the source around the top row under the list */
+static int g_preview = 0;
+static int g_preview_height = 0;
+static xfcache_t *files = NULL;
+
+/* wrapped descriptions, by row id */
+static flayout_t *layout = NULL;
+
+/* the width descriptions are wrapped at, row heights are for it */
+static int g_wrap_width = 0;
 
-  char *type = (char *)xarray_get(errors, INFO_TYPE_INDEX);
-  info_type_t info_type = info_type_get(type);  
-  
-  info_type_printstr(info_type, 30, newpath);
-  info_type_printstr(info_type, 4, (char *)xarray_get(errors, LINE_NUM_INDEX));
-  info_type_printstr(info_type, 10, type);
-  
 #define WIDTH_CHARS (50)
-  aligned = col - WIDTH_CHARS - 4;
+static int fhelper_wrap_width(int col)
+{
+  int aligned = col - WIDTH_CHARS - 4;
+
   if(aligned < WIDTH_CHARS)
     aligned = WIDTH_CHARS;
+
+  return aligned;
+}
+
+/* 
+ * placeholders print their count first, room for 10 digits and a space is
+ * kept so the height does not change with the count
+ */
+#define NOTES_COUNT_CHARS (11)
+static const flayout_row_t *fhelper_layout(unsigned int id, 
+                                           const finfo_t *info)
+{
+  int width = g_wrap_width;
+
+  if(info->flags & FINFO_VOLATILE)
+    width -= NOTES_COUNT_CHARS;
+
+  return flayout_get(layout, id, info->desc, width);
+}
+
+/* the store sums these in its indexes */
+static unsigned int fhelper_row_height(void *ctx, fstore_t *store, 
+                                       unsigned int id)
+{
+  return fhelper_layout(id, fstore_row(store, id))->count + 1;
+}
+
+/* wrap at the width of col columns, all rows are weighed again */
+static void fhelper_wrap(int col)
+{
+  int width = fhelper_wrap_width(col);
+
+  if(width == g_wrap_width)
+    return;
+
+  g_wrap_width = width;
+  fstore_set_height(store, fhelper_row_height, NULL);
+}
+
+static void dump_infos(unsigned int id)
+{
+  finfo_t *info = fstore_row(store, id);
+  if(!info)
+    return;
+
+  const char *newpath = fstore_path_alias(store, info);
+  char linestr[16] = "";
+
+  info_type_t info_type = info->type;
   
-  char *desc = (char *)xarray_get(errors, INFO_DESC_INDEX);
-  int desclen = strlen(desc);
+  snprintf(linestr, sizeof(linestr), "%u", info->line);
+  info_type_printcol(info_type, 30, newpath);
+  info_type_printstr(info_type, 4, linestr);
+  info_type_printstr(info_type, 10, info_type_name(info_type));
   
-  if(desclen > aligned) /* need to split it */
+  /* the breaks are cached per row, only a new width lays it out again */
+  const char *desc = info->desc;
+  const flayout_row_t *row = fhelper_layout(id, info);
+  int n = 0;
+
+  for(; n <= row->count && xscreen_lines_left(screen) > g_preview_height; n++)
+  {
+    unsigned int start = 0;
+    int len = flayout_line(row, desc, n, &start);
+
+    /* the rest of a cut row is not shown, say so on its last line */
+    if(n && n == row->count && row->cut)
+      xscreen_printf(screen, &xcolor_green_bold, "%40s... ", "");
+    else if(n)
+      xscreen_printf(screen, NULL, "%-44s", "");
+    else if(info->flags & FINFO_VOLATILE)
+      xscreen_printf(screen, &xcolor_green_bold, "%u ", 
+                     fnotes_hidden(notes, id));
+    info_type_printn(info_type, desc + start, len);
+    xscreen_newline(screen);
+  }
+}
+
+/* the listed row of the selected node, the first one if it is not there */
+static unsigned int fhelper_tree_find(const ftree_row_t *rows, 
+                                      unsigned int count)
+{
+  unsigned int i = 0;
+
+  for(; i < count; i++)
+  {
+    if(rows[i].node == g_tree_node)
+      return i;
+  }
+
+  return 0;
+}
+
+/* the listed directories from the top one, the selection stays on screen */
+static void fhelper_tree_draw(int lines)
+{
+  static const char *specs[2][INFO_TYPE_MAX] =
+  {
+    {"red bold", "yellow bold", "green bold", "green bold"},
+    {"red bold reverse", "yellow bold reverse", "green bold reverse", 
+     "green bold reverse"},
+  };
+  /* compiled once, the cache is a list walked by spec */
+  static const xcolor_t *colors[2][INFO_TYPE_MAX];
+  ftree_t *tree = store->tree;
+  ftree_row_t *rows = NULL;
+  unsigned int count = ftree_list(tree, &rows);
+  unsigned int sel = fhelper_tree_find(rows, count), i = 0;
+
+  if(!colors[0][0])
   {
     int j = 0;
-    xarray_t *descs = xstr2array(desc, " ");
-    int size = xarray_getcount(descs);
-    int len = 0, first_line = 1;
-    int from = 0, to = 0;
-    
-    for(; j < size; j++)
-    {
-      int item_len = strlen((char *)xarray_get(descs, j));
-      if(len + item_len > aligned || j == size - 1)
-      {
-        if(j == size - 1)
-          to = j;
-
-        char *aligned_desc = xarray2str_fromto_index(descs, from, to, ' ');
-        
-        if(first_line != 1)
-          printf("%-44s", "");  
-        info_type_printstr(info_type, 0, aligned_desc);  
-        printf("\n");
-        
-        /* need to check */
-        free(aligned_desc);
-        
-        from = j;
-        len = 0;
-        first_line--;
-      }
 
-      to = j;
-      len += item_len;
+    for(i = 0; i < 2; i++)
+      for(j = 0; j < INFO_TYPE_MAX; j++)
+        colors[i][j] = color_compile(specs[i][j]);
+  }
+
+  g_tree_page = lines > 1 ? lines : 1;
+  if(sel < g_tree_top)
+    g_tree_top = sel;
+  if(sel >= g_tree_top + g_tree_page)
+    g_tree_top = sel - g_tree_page + 1;
+
+  for(i = g_tree_top; i < count && xscreen_lines_left(screen) > 0; i++)
+  {
+    ftree_node_t *node = ftree_node(tree, rows[i].node);
+    info_type_t type = INFO_TYPE_NOTE;
+    const xcolor_t *color = NULL;
+    int indent = rows[i].depth * 2, pad = 0;
+    char label[256];
+
+    if(node->count[INFO_TYPE_ERROR])
+      type = INFO_TYPE_ERROR;
+    else if(node->count[INFO_TYPE_WARN])
+      type = INFO_TYPE_WARN;
+
+    ftree_label(tree, &rows[i], label, sizeof(label));
+    pad = WIDTH_CHARS - indent - (int)xwidth_str(label);
+    color = colors[i == sel][type];
+    xscreen_printf(screen, color, "%*s%s %s%*s", indent, "",
+                   node->child == FTREE_NONE ? " " : node->open ? "-" : "+",
+                   label, pad > 0 ? pad : 0, "");
+    xscreen_printf(screen, color, " %7u errors %7u warnings %7u notes",
+                   node->count[INFO_TYPE_ERROR], node->count[INFO_TYPE_WARN],
+                   node->count[INFO_TYPE_NOTE]);
+    xscreen_newline(screen);
+  }
+}
+
+/* 
+ * one source line, tabs expanded and control bytes shown as '?'. the
+ * caret goes under the display column gcc counts, wide characters take 2
+ */
+static void fhelper_preview_line(unsigned int n, const char *text, long len,
+                                 const finfo_t *info)
+{
+  char buf[512];
+  long i = 0;
+  int pos = 0, col = 0, caret = -1, bytes = 0, w = 0;
+
+  for(; i < len && pos < sizeof(buf) - 8; i += bytes)
+  {
+    if(info && info->offset && caret < 0 && col >= info->offset - 1)
+      caret = col;
+
+    bytes = 1;
+    if(text[i] == '\t')
+    {
+      do
+        buf[pos++] = ' ';
+      while(++col % 8);
+    }
+    else if(text[i] & 0x80)
+    {
+      /* a byte which is not utf-8 is shown as '?' too */
+      bytes = xwidth_next(text + i, len - i, &w);
+      if(bytes == 1)
+        buf[pos] = '?';
+      else
+        memcpy(buf + pos, text + i, bytes);
+      pos += bytes;
+      col += w;
+    }
+    else
+    {
+      buf[pos++] = iscntrl((unsigned char)text[i]) ? '?' : text[i];
+      col++;
     }
-    
-    xarray_destroy(descs);
   }
-  else
+  buf[pos] = '\0';
+
+  xscreen_printf(screen, NULL, "%6u  ", n);
+  if(!info)
   {
-    info_type_printstr(info_type, 0, desc); 
-    printf("\n");
+    xscreen_printf(screen, NULL, "%s", buf);
+    xscreen_newline(screen);
+    return;
+  }
+
+  /* the line of the row in its color, a caret under its column */
+  info_type_printstr(info->type, 0, buf);
+  xscreen_newline(screen);
+  if(caret >= 0 && xscreen_lines_left(screen) > 0)
+  {
+    xscreen_printf(screen, NULL, "%8s%*s", "", caret, "");
+    info_type_printstr(info->type, 0, "^");
+    xscreen_newline(screen);
   }
-  
-  if(newpath)
-    free(newpath);
 }
 
-typedef enum{
-  SCROLL_UP,
-  SCROLL_DOWN,
-  SCROLL_PAGEUP,
-  SCROLL_PAGEDOWN,
-}scroll_type_t;
+/* the store and what is built over it, the figure --max-mem is about */
+static size_t fhelper_bytes()
+{
+  size_t bytes = fstore_bytes(store);
+
+  if(layout)
+    bytes += flayout_bytes(layout);
+  if(filter)
+    bytes += ffilter_bytes(filter);
+  if(rules)
+    bytes += frules_bytes(rules);
+
+  return bytes;
+}
 
-/* 1: up, 0: down */
-static unsigned int refresh_scroll(unsigned int current_offset, scroll_type_t type)
+/* evicted rows give back their layout */
+static int fhelper_alive(void *ctx, unsigned int id)
 {
-  int lines = 0, col = 0;
-  unsigned int others = xqueue_nodes(other_queue);
-  unsigned int errors = xqueue_nodes(err_queue);
-  get_terminal_width_height(1, &col, &lines);
+  finfo_t *row = fstore_row((fstore_t *)ctx, id);
 
-  /* first two lines are used by statitics */
-  lines -= 2;
-  
-  if(others == 0)
+  return row && !(row->flags & FINFO_DEAD);
+}
+
+/* 
+ * the store gets what the rest leaves of the budget. rows only leave
+ * tombstones behind, a flood of them can still go past it
+ */
+static void fhelper_trim()
+{
+  size_t others = 0;
+
+  if(!g_max_mem)
+    return;
+
+  others = fhelper_bytes() - fstore_bytes(store);
+  if(!fstore_trim(store, g_max_mem > others ? g_max_mem - others : 1))
+    return;
+
+  if(layout)
+    flayout_prune(layout, fhelper_alive, store);
+  if(notes)
+    fnotes_prune(notes);
+}
+
+/* 
+ * the source lines around the top row. return 1 if the file is not indexed
+ * that far yet, the next frame goes on with it
+ */
+static int fhelper_preview()
+{
+  finfo_t *info = fstore_row(store, fview_top_id(&view));
+  xfcache_file_t *file = NULL;
+  const char *path = NULL;
+  unsigned int n = 1;
+
+  if(!info)
     return 0;
-  
-  switch(type)
+
+  path = fstore_path(store, info);
+  xscreen_printf(screen, &xcolor_green_bold, "-- %s:%u", path, info->line);
+  xscreen_newline(screen);
+
+  file = xfcache_get(files, path);
+  if(!file || !file->data)
   {
-    case SCROLL_DOWN:
-      if(current_offset >= others + errors - 1)
-        return others + errors - 1;
-      
-      return current_offset + 1;
-      break;
-    case SCROLL_UP:
-      if(current_offset)
-        return current_offset - 1;
-      
-      return 0;
-      break;
-    case SCROLL_PAGEDOWN:
-      if(current_offset + lines >= others + errors - 1)
-        return others + errors - 1;
-      return current_offset + lines - 1;
-      break;
-    case SCROLL_PAGEUP:
-      if(current_offset > lines)
-        return current_offset - lines + 1;
-      return 0;  
-      break;
-    default:
+    xscreen_printf(screen, &xcolor_yellow_bold, "can't read %s", path);
+    xscreen_newline(screen);
+    return 0;
+  }
+
+  /* the line of the row goes in the middle, its caret under it */
+  if(info->line > (g_preview_height - 2) / 2)
+    n = info->line - (g_preview_height - 2) / 2;
+
+  for(; xscreen_lines_left(screen) > 0; n++)
+  {
+    const char *text = NULL;
+    long len = xfcache_line(file, n, &text);
+
+    if(len == XFCACHE_AGAIN)
+    {
+      xscreen_printf(screen, &xcolor_yellow_bold, "indexing %s ...", path);
+      xscreen_newline(screen);
+      return 1;
+    }
+
+    if(len < 0)
       break;
+
+    fhelper_preview_line(n, text, len, n == info->line ? info : NULL);
   }
-      
+
   return 0;
 }
 
-static void refresh_infos(unsigned int offset)
+/* return 1 if the frame is not complete, another one should follow */
+static int refresh_infos()
 {
   int lines = 0, col = 0;
-  unsigned int errors = xqueue_nodes(err_queue);
-  unsigned int others = xqueue_nodes(other_queue);
+  unsigned int errors = fstore_type_count(store, INFO_TYPE_ERROR);
+  unsigned int others = fstore_live(store) - errors;
+  xsknode_t *node = NULL;
+  char mem[16] = "", max_mem[16] = "";
+  int again = 0;
   
-  get_terminal_width_height(1, &col, &lines);
-  printf(SCREEN_CLEAR); /* clear the screen */
+  terminal_geometry(&col, &lines);
+  xscreen_resize(screen, col, lines);
+  xscreen_begin(screen);
+
+  /* the preview takes a third of a big enough screen, under the list */
+  g_preview_height = 0;
+  if(g_preview && !g_tree && lines > 20)
+    g_preview_height = lines / 3;
+
+  /* the list scrolls under the statistics, new rows cost a line each */
+  xscreen_set_scroll(screen, 2, lines - g_preview_height);
+  fhelper_wrap(col);
+
+  /* first two lines are used by statitics */
+  fview_set_page(&view, lines - 2 - g_preview_height);
+  fview_clamp(&view);
   
   /* show statitics */
-  xwprintf("%-10s%-5u-%5s", "errors", errors, "");
-  xnprintf("%-10s%-5u-%5s", "others", others, "");
-  xnprintf("%-15s%-5u-%5s", "auto refresh", g_auto_refresh, "");
-  xnprintf("%-10s%-5u\n\n", "scroll", offset);
+  xscreen_printf(screen, &xcolor_red_bold, "%-7s%-7u", "errors", errors);
+  xscreen_printf(screen, &xcolor_yellow_bold, "%-7s%-7u", "others", others);
+  xscreen_printf(screen, &xcolor_yellow_bold, "%-13s%-3u", "auto refresh", 
+                 g_auto_refresh);
+  xscreen_printf(screen, &xcolor_yellow_bold, "%-7s%-7llu", "scroll", view.top);
+  xscreen_printf(screen, &xcolor_yellow_bold, "%-6s%-10s", "order", 
+                 fsort_name(view.sort));
+  xscreen_printf(screen, &xcolor_yellow_bold, "%-4s%s/%s", "mem", 
+                 fhelper_size_str(fhelper_bytes(), mem),
+                 g_max_mem ? fhelper_size_str(g_max_mem, max_mem) : "-");
+  if(store->evicted)
+    xscreen_printf(screen, &xcolor_yellow_bold, " (%u evicted)", store->evicted);
+  if(notes && notes->hidden)
+    xscreen_printf(screen, &xcolor_green_bold, " %llu notes aside", 
+                   notes->hidden);
+  if(known && fbaseline_hits(known))
+    xscreen_printf(screen, &xcolor_green_bold, " %u known", 
+                   fbaseline_hits(known));
+  if(rules && rules->ignored)
+    xscreen_printf(screen, &xcolor_green_bold, " %lu ignored", 
+                   rules->ignored);
+  if(view.follow)
+    xscreen_printf(screen, &xcolor_green_bold, " follow");
+  if(g_tree)
+    xscreen_printf(screen, &xcolor_green_bold, " tree");
+  if(g_dropped)
+    xscreen_printf(screen, &xcolor_yellow_bold, " %lu dropped", g_dropped);
+  xscreen_newline(screen);
+
+  /* the search and the filter line */
+  if(search)
+    xscreen_printf(screen, &xcolor_yellow_bold, "/%s%s  ", search->query, 
+                   g_typing == '/' ? "_" : "");
+  if(search && fsearch_active(search))
+    xscreen_printf(screen, &xcolor_yellow_bold, "%u matches  ", 
+                   fsearch_count(search));
+  if(g_typing == ':')
+    xscreen_printf(screen, &xcolor_yellow_bold, ":%s_", g_line);
+  else if(filter && ffilter_active(filter))
+  {
+    char terms[256];
+
+    ffilter_describe(filter, terms, sizeof(terms));
+    xscreen_printf(screen, &xcolor_yellow_bold, ":%s  %u rows", terms, 
+                   xskiplist_count(filter->subset));
+  }
+  xscreen_newline(screen);
 
   /* at least show 20 lines */
   if(lines <= 20)
+    goto out;
+
+  if(g_tree)
+  {
+    fhelper_tree_draw(lines - 2);
+    goto out;
+  }
+
+  /* walk the current sort index from the offset till the screen is full */
+  node = xskiplist_at(fview_index(&view), view.top);
+  for(; node && xscreen_lines_left(screen) > g_preview_height; 
+      node = xskiplist_next(node))
+    dump_infos(node->id);
+
+  if(g_preview_height)
+  {
+    while(xscreen_lines_left(screen) > g_preview_height)
+      xscreen_newline(screen);
+    again = fhelper_preview();
+  }
+
+out:
+  /* anything still in stdio goes first, the frame bypasses it */
+  fflush(stdout);
+  xscreen_flush(screen, STDOUT_FILENO);
+  return again;
+}
+
+/* 
+ * show the search matches the filter lets through, row id goes on top if
+ * it is there. a short query or no term on doesn't narrow anything
+ */
+static void fhelper_show(unsigned int id)
+{
+  xskiplist_t *subset = NULL;
+
+  if(search && fsearch_active(search))
+    subset = search->subset;
+
+  if(filter && ffilter_active(filter))
+  {
+    ffilter_apply(filter, subset);
+    subset = filter->subset;
+  }
+
+  fview_set_subset(&view, subset, id);
+}
+
+/* show the rows matching query from the first one */
+static void fhelper_search(const char *query, int len)
+{
+  unsigned int id = fview_top_id(&view);
+
+  fsearch_set(search, query, len);
+  fhelper_show(fsearch_active(search) ? FSTORE_NONE : id);
+}
+
+static void fhelper_search_end()
+{
+  unsigned int id = fview_top_id(&view);
+  fsearch_t *old = search;
+
+  /* the subset shown goes away with it */
+  search = NULL;
+  fhelper_show(id);
+  fsearch_destroy(old);
+  g_typing = 0;
+}
+
+/* mark the rows from id on which the baseline knows, the db does not say */
+static void fhelper_known(unsigned int id)
+{
+  for(; known && id < fstore_count(store); id++)
+  {
+    finfo_t *row = fstore_row(store, id);
+
+    if(!(row->flags & FINFO_DEAD) && fbaseline_match(known, store, row))
+      row->flags |= FINFO_KNOWN;
+  }
+}
+
+/* toggle the terms of line, none turns all of them off */
+static void fhelper_filter(char *line)
+{
+  unsigned int id = fview_top_id(&view);
+  finfo_t *top = fstore_row(store, id);
+  char *term = NULL, *save = NULL;
+
+  if(!filter)
+    filter = ffilter_create(store, view.sort);
+  if(!filter)
     return;
 
-  /* first two lines are used by statitics */
-  lines -= 3; /* last line can't show out, why? */
-  
-  if(offset > errors) /* no need to show errors */
+  if(!strtok_r(line, " ", &save))
+    ffilter_clear(filter);
+  else
+  {
+    /* ~ is the template of the top row */
+    for(term = line; term; term = strtok_r(NULL, " ", &save))
+      ffilter_toggle(filter, term, top ? top->tmpl_id : XINTERN_NONE);
+  }
+
+  fhelper_show(id);
+}
+
+/* edit the typed line with c, return 1 for Enter, -1 for ESC */
+static int fhelper_edit(unsigned char c)
+{
+  if(c == '\033')
+    return -1;
+
+  if(c == '\r' || c == '\n')
+    return 1;
+
+  if((c == 0x7f || c == '\b') && g_line_len > 0)
+    g_line_len--;
+  else if(isprint(c) && g_line_len < sizeof(g_line) - 1)
+    g_line[g_line_len++] = c;
+
+  g_line[g_line_len] = '\0';
+  return 0;
+}
+
+/* move the tree selection by n listed rows */
+static void fhelper_tree_move(long long n)
+{
+  ftree_row_t *rows = NULL;
+  unsigned int count = ftree_list(store->tree, &rows);
+  long long sel = fhelper_tree_find(rows, count) + n;
+
+  if(!count)
+    return;
+
+  if(sel < 0)
+    sel = 0;
+  if(sel >= count)
+    sel = count - 1;
+  g_tree_node = rows[sel].node;
+}
+
+/* scroll the list or move the selection of the tree */
+static void fhelper_move(int pages, long long rows)
+{
+  if(g_tree)
   {
-    offset -= errors;
-    xqueue_traverse_fromto(other_queue, dump_infos, offset, offset + lines - 1); 
+    fhelper_tree_move(rows + (long long)pages * g_tree_page);
+    return;
   }
-  else //if(offset <= errors)/* only need to show part of errors */
+
+  fview_page(&view, pages);
+  fview_scroll(&view, rows);
+}
+
+/* open the tree at the file of the top row */
+static void fhelper_tree_open()
+{
+  finfo_t *top = fstore_row(store, fview_top_id(&view));
+  ftree_t *tree = store->tree;
+  unsigned int id = FTREE_NONE;
+
+  if(top && top->path_id < tree->file_size)
+    id = tree->files[top->path_id];
+
+  g_tree = 1;
+  g_tree_node = id;
+  for(; id != FTREE_NONE; id = ftree_node(tree, id)->parent)
   {
-    xqueue_traverse_fromto(err_queue, dump_infos, offset, offset + lines - 1); 
+    if(id != g_tree_node)
+      ftree_node(tree, id)->open = 1;
+  }
+}
+
+/* 
+ * the keys of the tree: right opens a directory, left closes it or goes
+ * up, Enter shows its rows. the moves before key are done first. return 1
+ * if key is one of them
+ */
+static int fhelper_tree_key(const terminal_key_t *key, int *pages, 
+                            long long *rows)
+{
+  ftree_row_t *list = NULL;
+  ftree_node_t *node = NULL;
+  unsigned int count = 0, sel = 0, depth = 0;
+
+  int enter = key->code == TERMINAL_KEY_CHAR 
+              && (key->c == '\r' || key->c == '\n');
+
+  if(key->code != TERMINAL_KEY_LEFT && key->code != TERMINAL_KEY_RIGHT
+     && key->code != TERMINAL_KEY_HOME && key->code != TERMINAL_KEY_END
+     && !enter)
+    return 0;
+
+  fhelper_move(*pages, *rows);
+  *pages = *rows = 0;
+
+  count = ftree_list(store->tree, &list);
+  if(!count)
+    return 1;
+
+  sel = fhelper_tree_find(list, count);
+  node = ftree_node(store->tree, list[sel].node);
+  depth = list[sel].depth;
+
+  switch(key->code)
+  {
+    case TERMINAL_KEY_HOME:
+      fhelper_tree_move(-(long long)UINT_MAX);
+      break;
+    case TERMINAL_KEY_END:
+      fhelper_tree_move(UINT_MAX);
+      break;
+    case TERMINAL_KEY_RIGHT:
+      node->open = node->child != FTREE_NONE;
+      break;
+    case TERMINAL_KEY_LEFT:
+      if(node->open)
+        node->open = 0;
+      else if(depth)
+      {
+        while(sel > 0 && list[sel].depth >= depth)
+          sel--;
+        g_tree_node = list[sel].node;
+      }
+      break;
+    default:
+      /* Enter toggles the directory in the filter and shows the rows */
+      if(node->child != FTREE_NONE)
+      {
+        char path[PATH_MAX] = "";
+
+        if(!filter)
+          filter = ffilter_create(store, view.sort);
+        if(!filter)
+          break;
+
+        if(!ftree_path(store->tree, list[sel].node, path, sizeof(path)))
+          strcpy(path, "/");
+        ffilter_toggle(filter, path, XINTERN_NONE);
+        g_tree = 0;
+        fhelper_show(FSTORE_NONE);
+      }
+      break;
+  }
+
+  return 1;
+}
+
+/* 
+ * all keys of one read are handled together, scrolls are only summed and
+ * the view moves once. flush takes what is left of a sequence as keys.
+ * return -1 to quit
+ */
+static int fhelper_keys(int *dirty, int flush)
+{
+  static terminal_key_t keys[TERMINAL_KEY_BUF];
+  unsigned long long old_top = view.top;
+  unsigned int old_node = g_tree_node;
+  long long rows = 0;
+  int pages = 0;
+  int query = 0; /* the query is searched once after all the keys */
+  int count = flush ? terminal_flush_keys(keys, TERMINAL_KEY_BUF)
+                    : terminal_read_keys(STDIN_FILENO, keys, TERMINAL_KEY_BUF);
+  int i = 0;
+
+  for(; i < count; i++)
+  {
+    unsigned char c = keys[i].c;
+
+    if(g_tree && !g_typing && fhelper_tree_key(&keys[i], &pages, &rows))
+    {
+      *dirty = 1;
+      continue;
+    }
+
+    switch(keys[i].code)
+    {
+      case TERMINAL_KEY_UP:
+      case TERMINAL_KEY_LEFT:
+        rows--;
+        continue;
+      case TERMINAL_KEY_DOWN:
+      case TERMINAL_KEY_RIGHT:
+        rows++;
+        continue;
+      case TERMINAL_KEY_WHEEL_UP:
+        rows -= 3;
+        continue;
+      case TERMINAL_KEY_WHEEL_DOWN:
+        rows += 3;
+        continue;
+      case TERMINAL_KEY_PGUP:
+        pages--;
+        continue;
+      case TERMINAL_KEY_PGDN:
+        pages++;
+        continue;
+      default:
+        break;
+    }
+
+    /* the moves so far go first, the keys below are absolute */
+    fhelper_move(pages, rows);
+    pages = rows = 0;
+
+    if(keys[i].code == TERMINAL_KEY_HOME)
+      fview_home(&view);
+    if(keys[i].code == TERMINAL_KEY_END)
+      fview_end(&view);
+    if(keys[i].code != TERMINAL_KEY_CHAR)
+      continue;
+
+    /* Ctrl+C */
+    if(c == terminal_ctrlc())
+      return -1;
+
+    /* 
+     * typing a search: ESC drops it, Enter keeps it. typing filter terms:
+     * ESC drops the line, Enter toggles the terms
+     */
+    if(g_typing)
+    {
+      int ret = fhelper_edit(c);
+
+      if(g_typing == '/' && ret < 0)
+        fhelper_search_end();
+      else if(g_typing == '/')
+        query = 1;
+      else if(ret > 0)
+        fhelper_filter(g_line);
+
+      if(ret)
+        g_typing = 0;
+      *dirty = 1;
+      continue;
+    }
+
+    /* ESC drops a search kept with Enter */
+    if(c == '\033' && search)
+    {
+      fhelper_search_end();
+      *dirty = 1;
+      continue;
+    }
+
+    if(c == '/' || c == ':')
+    {
+      if(c == '/' && !search)
+        search = fsearch_create(store, view.sort);
+      if(c == ':' || search)
+        g_typing = c;
+
+      /* a search goes on from its query, terms start anew */
+      g_line_len = c == '/' && search ? search->len : 0;
+      memcpy(g_line, c == '/' && search ? search->query : "", g_line_len);
+      g_line[g_line_len] = '\0';
+      *dirty = 1;
+      continue;
+    }
+    
+    /* 'Q' or 'q' to quit */
+    c = (char)tolower((int)c);
+    if(c == 'q')
+      return -1;
+    
+    /* the directory tree, it opens where the top row is */
+    if(c == 't')
+    {
+      if(g_tree)
+        g_tree = 0;
+      else
+        fhelper_tree_open();
+      *dirty = 1;
+    }
+
+    if(c == 'p')
+    {
+      g_preview = !g_preview;
+      *dirty = 1;
+    }
+
+    /* the notes of a placeholder become rows, the first one goes on top */
+    if(c == 'x' && notes)
+    {
+      unsigned int id = fnotes_expand(notes, fview_top_id(&view));
+
+      if(id != FSTORE_NONE)
+      {
+        if(search)
+          fsearch_update(search);
+        if(filter)
+          ffilter_update(filter, search && fsearch_active(search) ? 
+                         search->subset : NULL);
+        fview_set_subset(&view, view.subset, id);
+        *dirty = 1;
+      }
+    }
+
+    if(c == 'd')
+    {
+      xscreen_invalidate(screen);
+      *dirty = 1;
+    }
+    
+    /* switch to the next sort order, the indexes are always ready */
+    if(c == 'o')
+    {
+      fview_sort(&view, (view.sort + 1) % FSORT_MAX);
+
+      /* the subsets which are not shown follow it too */
+      if(search)
+        fstore_subset_sort(store, search->subset, view.sort);
+      if(filter)
+        fstore_subset_sort(store, filter->subset, view.sort);
+      *dirty = 1;
+    }
+
+    /* jumps, all of them are lookups in the index */
+    if(c == 'e')
+      fview_next_error(&view);
+
+    if(c == 'f')
+      fview_next_file(&view);
+
+    /* 0-9 go to 0%-90% of the list */
+    if(isdigit(c))
+      fview_percent(&view, (c - '0') * 10);
     
-    if(lines + offset > errors) /* need to show part of other queue */
-      xqueue_traverse_fromto(other_queue, dump_infos, 0, lines + offset - errors - 1); 
+    /* enable or disable auto refresh */
+    if(c == 's')
+    {
+      auto_refresh_reverse();
+      *dirty = 1; /* show the auto refresh flag */
+    }
+  }
+
+  if(search && query)
+  {
+    fhelper_search(g_line, g_line_len);
+
+    /* an empty query left with Enter is no search */
+    if(!g_line_len && g_typing != '/')
+      fhelper_search_end();
+  }
+
+  fhelper_move(pages, rows);
+  if(old_top != view.top || old_node != g_tree_node)
+    *dirty = 1;
+
+  return 0;
+}
+
+/* 
+ * --emit: stdin to fd with nothing in between but the parser, the output
+ * of a read goes out before the next read may block
+ */
+static int fhelper_emit(femit_format_t format, const char *out_path)
+{
+  fstore_t *store = fstore_create(NULL);
+  femit_t *emit = NULL;
+  xlines_t lines;
+  finfo_t info;
+  char *line = NULL;
+  int fd = STDOUT_FILENO, ret = -1;
+
+  xlines_init(&lines);
+  if(out_path)
+  {
+    fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+      perror(out_path);
+      goto end;
+    }
+  }
+
+  emit = femit_create(format, store, fd);
+  if(emit)
+    emit->known = known;
+  if(!store || !emit)
+    goto end;
+
+  /* only the paths and the flags are kept, the rows are not stored */
+  while(xlines_read(&lines, STDIN_FILENO) > 0)
+  {
+    while((line = xlines_next(&lines)))
+    {
+      if(fstore_parse(store, line, &info) == 0 
+         && info.type != INFO_TYPE_UNKNOWN 
+         && (!rules || frules_apply(rules, store, &info) == 0)
+         && femit_row(emit, &info) < 0)
+        goto end;
+    }
+
+    if(femit_flush(emit) < 0)
+      goto end;
   }
+
+  line = xlines_rest(&lines);
+  if(line && fstore_parse(store, line, &info) == 0 
+     && info.type != INFO_TYPE_UNKNOWN
+     && (!rules || frules_apply(rules, store, &info) == 0))
+    femit_row(emit, &info);
+  ret = femit_flush(emit);
+
+  if(known && fbaseline_hits(known))
+    fprintf(stderr, "%u known diagnostics left out\n", fbaseline_hits(known));
+
+end:
+  femit_destroy(emit);
+  fstore_destroy(store);
+  xlines_release(&lines);
+  if(fd != STDOUT_FILENO && fd >= 0)
+    close(fd);
+
+  return ret < 0 ? 1 : 0;
 }
 
 int main(int argc, char *argv[])
 {
   int ret = 0;
+  int col = 0;
 
   int pipe_fd = -1; 
   int option_index = 0;
-  unsigned char screen_offset = 0;
+  char db_buf[PATH_MAX];
+  const char *db_path = fhelper_db_path(db_buf, sizeof(db_buf));
+  fdb_t *db = NULL;
+  femit_format_t emit = FEMIT_MAX;
+  const char *out_path = NULL;
+  xlines_t pipe_lines;
   
   static struct option long_options[] =
   {
     /* These options set a flag. */
     {"help",      no_argument,       0, 'h'},
+    {"db",        required_argument, 0, 'b'},
+    {"nodb",      no_argument,       0, 'n'},
+    {"max-mem",   required_argument, 0, 'm'},
+    {"fps",       required_argument, 0, 'f'},
+    {"max-notes", required_argument, 0, 'N'},
+    {"emit",      required_argument, 0, 'e'},
+    {"output",    required_argument, 0, 'o'},
+    {"baseline",  required_argument, 0, 'B'},
+    {"rules",     required_argument, 0, 'r'},
     {0, 0, 0, 0}
   };
 
   while(1)
   {
-    ret = getopt_long(argc, argv, "h",
+    ret = getopt_long(argc, argv, "hb:nm:f:e:o:N:B:r:",
                       long_options, &option_index);
 
      /* Detect the end of the options. */
@@ -477,22 +1406,110 @@ int main(int argc, char *argv[])
       case 'h':
         usage();
         return 0;
+      case 'b':
+        db_path = optarg;
+        break;
+      case 'n':
+        db_path = NULL;
+        break;
+      case 'm':
+        if(fhelper_parse_size(optarg, &g_max_mem) < 0)
+        {
+          usage();
+          return 1;
+        }
+        break;
+      case 'f':
+        g_fps = atoi(optarg);
+        if(g_fps < 1)
+          g_fps = 1;
+        if(g_fps > 1000)
+          g_fps = 1000;
+        break;
+      case 'N':
+        g_max_notes = atoi(optarg) > 0 ? atoi(optarg) : 0;
+        break;
+      case 'e':
+        emit = femit_format_get(optarg);
+        if(emit == FEMIT_MAX)
+        {
+          usage();
+          return 1;
+        }
+        break;
+      case 'o':
+        out_path = optarg;
+        break;
+      case 'B':
+        known = fbaseline_create();
+        if(!known || fbaseline_load(known, optarg) < 0)
+          return 1;
+        break;
+      case 'r':
+        rules = frules_load(optarg);
+        if(!rules)
+          return 1;
+        break;
       default:
         break;
     }
   }
   
+  /* no terminal, no pipe file and no db in a pipeline */
+  if(emit != FEMIT_MAX)
+  {
+    ret = fhelper_emit(emit, out_path);
+    fbaseline_destroy(known);
+    frules_destroy(rules);
+    return ret;
+  }
+
   fhelper_logo();
   usleep(5000);
   terminal_init();
 
-  err_queue = xqueue_create(0, (xqueue_free_f)xarray_destroy);
-  other_queue = xqueue_create(0, (xqueue_free_f)xarray_destroy);
-  if(!err_queue || !other_queue)
+  store = fstore_create(fhelper_shrink_path);
+  screen = xscreen_create();
+  layout = flayout_create();
+  files = xfcache_create(PREVIEW_FILES, PREVIEW_BYTES);
+  if(!store || !screen || !layout || !files)
   {
-    printf("faile to create info queue");
+    printf("faile to create info store");
     goto end;
   }
+  fview_init(&view, store);
+
+  /* rows are weighed by their wrapped height as they come */
+  terminal_geometry(&col, NULL);
+  fhelper_wrap(col);
+
+  /* show the last state at once, rows are used from the mapping */
+  if(db_path)
+  {
+    /* a db another fhelper holds is left to it, this one runs without */
+    db = fdb_open(db_path);
+    if(db && fdb_load(db, store) < 0)
+      printf("faile to load %s.\n", db_path);
+  }
+  fhelper_known(0);
+  fhelper_trim();
+
+  /* evictions are not saved, the file only keeps what is left of it */
+  if(db && fstore_count(store))
+    fdb_compact(db, store);
+
+  /* without a spool every note is kept */
+  if(g_max_notes)
+    notes = fnotes_create(store, g_max_notes);
+
+  /* the known diagnostics are there, hidden till "!known" is toggled */
+  if(known)
+  {
+    filter = ffilter_create(store, view.sort);
+    if(filter)
+      ffilter_toggle(filter, "!known", XINTERN_NONE);
+    fhelper_show(FSTORE_NONE);
+  }
     
   /* only under scan mode, create pipe */
   pipe_fd = fhelper_pipe_create();
@@ -503,30 +1520,86 @@ int main(int argc, char *argv[])
   }
 
   /* set the pipe fd and stdin into the fds_set */
-  fd_set fds_set, read_set;
+  fd_set fds_set, read_set, write_set;
   
-  int fds[2] = {0};
+  int fds[3] = {0};
   int fds_count = 0;
   int max_fd = 0;
-  char recvbuf[RECV_BUFSIZE] = "";
+  char *line = NULL;
+
+  xlines_init(&pipe_lines);
 
   /* add stdin to accept quit key 'q' */
   fds[fds_count++] = STDIN_FILENO;
   fds[fds_count++] = pipe_fd;
+  if(terminal_winch_fd() >= 0)
+    fds[fds_count++] = terminal_winch_fd();
   max_fd = xfdset(&fds_set, fds, fds_count);
 
-  /* every 3 second refresh the screen */
-  unsigned interval = 1;
-  struct timeval tv;
+  /* 
+   * events only mark the screen dirty, a dirty screen is drawn as soon as
+   * the last frame is 1/g_fps old. select() blocks with no timeout while
+   * nothing is pending, so an idle fhelper never wakes up.
+   *
+   * a frame is dropped while the terminal still has output queued, a
+   * slow link then gets only the latest state once it catches up
+   */
+  unsigned long long frame_us = 1000000 / g_fps;
+  unsigned long long last_frame = 0;
+  int dirty = 1; /* show what the db brought at once */
+  unsigned int saved = fstore_count(store); /* rows before it are in the db */
+  struct timeval tv, *timeout = NULL;
+  int esc_wait = 0;
   
   do
   {
-    tv.tv_sec = interval;
-    tv.tv_usec = 0;
+    timeout = NULL;
+    esc_wait = 0;
+    if(dirty)
+    {
+      unsigned long long now = fhelper_now_us();
+
+      unsigned long long pace_us = xscreen_pace_us(screen);
+
+      if(pace_us < frame_us)
+        pace_us = frame_us;
+
+      if(now - last_frame >= pace_us)
+      {
+        if(xscreen_pending(screen) || terminal_backlog(STDOUT_FILENO) > 0)
+          g_dropped++;
+        else
+        {
+          dirty = refresh_infos();
+        }
+        last_frame = now;
+      }
+      else
+      {
+        tv.tv_sec = (pace_us - (now - last_frame)) / 1000000;
+        tv.tv_usec = (pace_us - (now - last_frame)) % 1000000;
+        timeout = &tv;
+      }
+    }
+
+    /* a lone ESC is a key once nothing follows it for a while */
+    if(terminal_keys_pending() && (!timeout || tv.tv_sec 
+                                   || tv.tv_usec >= TERMINAL_ESC_MS * 1000))
+    {
+      tv.tv_sec = 0;
+      tv.tv_usec = TERMINAL_ESC_MS * 1000;
+      timeout = &tv;
+      esc_wait = 1;
+    }
   
+    /* wait for the terminal to take the rest of the last frame */
+    FD_ZERO(&write_set);
+    if(xscreen_pending(screen))
+      FD_SET(STDOUT_FILENO, &write_set);
+
     /* reset the fd set */
     read_set = fds_set;
-    ret = select(max_fd + 1, &read_set, NULL, NULL, &tv);
+    ret = select(max_fd + 1, &read_set, &write_set, NULL, timeout);
     if(ret < 0)
     {
       if(errno != EINTR)
@@ -535,87 +1608,42 @@ int main(int argc, char *argv[])
       continue;
     }
     
-    /* time out, refresh the screen */
+    /* time out, the pending frame or the ESC is due */
     if(ret == 0)
     {
-      if(auto_refresh_get())
-        refresh_infos(screen_offset);
+      if(esc_wait && fhelper_keys(&dirty, 1) < 0)
+        break;
       continue;
     }
 
-    /* handle quit key */
+    if(FD_ISSET(STDOUT_FILENO, &write_set))
+      xscreen_drain(screen, STDOUT_FILENO);
+
+    /* the terminal was resized, lay the frame out again */
+    if(terminal_winch_fd() >= 0 && FD_ISSET(terminal_winch_fd(), &read_set))
+    {
+      if(terminal_winch())
+        dirty = 1;
+    }
+
+    /* handle the keys, a storm of them makes one frame */
     if(FD_ISSET(STDIN_FILENO, &read_set)) 
     {
-      unsigned char c = 0;
-      if(safe_read(STDIN_FILENO, &c, 1) != 1)
-        continue;
-      
-      /* Ctrl+C */
-      if(c == terminal_ctrlc())
+      if(fhelper_keys(&dirty, 0) < 0)
         break;
-      
-      /* 'Q' or 'q' to quit */
-      c = (char)tolower((int)c);
-      if(c == 'q')
-        break;
-      
-      if(c == 'd')
-        refresh_infos(screen_offset);
-      
-      /* enable or disable auto refresh */
-      if(c == 's')
-      {
-        auto_refresh_reverse();
-        refresh_infos(screen_offset); /* show the auto refresh flag */
-      }
 
-      /* 27 means a ctrl command */
-      if(c == '\033')
-      {
-        if(safe_read(STDIN_FILENO, &c, 1) != 1)
-          continue;
-        
-        /* the follow character must be '[' */
-        if(c != '[')
-          continue;
-        
-        if(safe_read(STDIN_FILENO, &c, 1) != 1)
-          continue;
-
-        //printf("c 0x%02x, %d, %d, %c\n", c, (int)c, '\033', c);
-        unsigned int old_offset = screen_offset;
-        switch(c) 
-        { 
-          case 'A': /* code for up */
-          case 'D': /* code for arrow left */
-            screen_offset = refresh_scroll(screen_offset, SCROLL_UP);
-            break;
-          case 'B': /* code for arrow down */
-          case 'C': /* code for arrow right */
-            screen_offset = refresh_scroll(screen_offset, SCROLL_DOWN);
-            break;
-          case '5': /* page up */
-            screen_offset = refresh_scroll(screen_offset, SCROLL_PAGEUP);
-            break;
-          case '6': /* page down */
-            screen_offset = refresh_scroll(screen_offset, SCROLL_PAGEDOWN);
-            break;  
-          default:
-            break;
-        }
-        
-        if(old_offset != screen_offset)
-          refresh_infos(screen_offset);
-      }
+      /* expanded notes are saved like the rows from the pipe */
+      if(db && saved < fstore_count(store))
+        fdb_append(db, store, saved, fstore_count(store));
+      saved = fstore_count(store);
     }
     
     /* handle pipe request */
     if(!FD_ISSET(pipe_fd, &read_set))
       continue;
     
-    ret = read(pipe_fd, recvbuf, RECV_BUFSIZE);
-    recvbuf[ret] = '\0';
-    
+    /* lines may come split over reads, they are put together first */
+    ret = xlines_read(&pipe_lines, pipe_fd);
     if(ret <= 0)
     {
       perror("read");
@@ -628,56 +1656,86 @@ int main(int argc, char *argv[])
      * Format: file.c:lineno:offset:reasonDesc [-Wreason] 
      *       
      */
-    //printf("fheler:%s\n", recvbuf);       
-    if(recvbuf[0] != '/')
-      continue;
-    
-    /* check private command */
-    if(strstr(recvbuf, "/flush/"))
-    {
-      xqueue_flush(err_queue);
-      xqueue_flush(other_queue);
-      continue;
-    }
-    
-    xarray_t *gccinfo = xstr2array(recvbuf, "\n");
-    int count = xarray_getcount(gccinfo);
-    int i = 0;
-    
-    for(; i < count; i++)
+    while((line = xlines_next(&pipe_lines)))
     {
-      /* find the warning and error info entry */
-      const char *info = xarray_get(gccinfo, i);
-      info_type_t info_type = info_type_get(info);
-
-      if(info_type == INFO_TYPE_UNKNOWN)
-        continue;
+      info_type_t info_type = info_type_get(line);
+      unsigned int id = FSTORE_NONE;
+      finfo_t *row = NULL;
+      finfo_t info;
 
-      /* now analyse the entry */
-      xarray_t *errors = xstr2array(info, ":");
-      //xarray_dump(errors);
-      
-      if(xarray_getcount(errors) >= 5)
+      /* check private command, the rows after it start anew */
+      if(!strcmp(line, "/flush/"))
       {
-        char *type = (char *)xarray_get(errors, INFO_TYPE_INDEX);
-        info_type_t info_type = info_type_get(type);
-        if(info_type == INFO_TYPE_ERROR)
-            xqueue_enqueue(err_queue, errors);
-        else
-            xqueue_enqueue(other_queue, errors);
+        fstore_flush(store);
+        flayout_flush(layout);
+        if(notes)
+          fnotes_flush(notes);
+        if(known)
+          fbaseline_flush(known);
+        if(search)
+          fsearch_update(search);
+        if(filter)
+          ffilter_update(filter, NULL);
+        if(db)
+          fdb_reset(db);
+        saved = 0;
+        continue;
       }
+
+      if(info_type == INFO_TYPE_UNKNOWN 
+         || fstore_parse(store, line, &info) < 0)
+        continue;
+
+      /* the rules go first, the known ones are hidden by "!known" */
+      if(rules && frules_apply(rules, store, &info) < 0)
+        continue;
+      if(known && fbaseline_match(known, store, &info))
+        info.flags |= FINFO_KNOWN;
+
+      /* now analyse the entry, the preview will want the files of errors */
+      if(notes)
+        id = fnotes_add(notes, line, &info);
       else
-        xarray_destroy(errors);
+        id = fstore_insert(store, &info, 1);
+      row = fstore_row(store, id);
+      if(g_preview && row && row->type == INFO_TYPE_ERROR)
+        xfcache_prefetch(files, fstore_path(store, row));
     }
+
+    /* the new rows which match join the search and the filter view */
+    if(search)
+      fsearch_update(search);
+    if(filter)
+      ffilter_update(filter, search && fsearch_active(search) ? 
+                     search->subset : NULL);
+    
+    /* save the new rows as one segment */
+    if(db)
+      fdb_append(db, store, saved, fstore_count(store));
+    saved = fstore_count(store);
     
-    xarray_destroy(gccinfo);
+    /* keep the errors, give up notes and old warnings */
+    fhelper_trim();
+
+    /* new rows show up with the next frame */
+    dirty |= auto_refresh_get();
   }while(1);
   
   fhelper_pipe_close(pipe_fd);
+  xlines_release(&pipe_lines);
 
 end:
-  xqueue_destroy(err_queue);
-  xqueue_destroy(other_queue);
+  /* rows may point into the db mapping, so drop them first */
+  fsearch_destroy(search);
+  ffilter_destroy(filter);
+  fnotes_destroy(notes);
+  fbaseline_destroy(known);
+  frules_destroy(rules);
+  fstore_destroy(store);
+  fdb_close(db);
+  xscreen_destroy(screen);
+  flayout_destroy(layout);
+  xfcache_destroy(files);
   
   terminal_reset();
 	return 0;
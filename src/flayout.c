@@ -0,0 +1,228 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flayout.h"
+#include "xwidth.h"
+
+flayout_t *flayout_create(void)
+{
+  flayout_t *layout = malloc(sizeof(flayout_t));
+  if(!layout)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(layout, 0, sizeof(flayout_t));
+  return layout;
+}
+
+void flayout_flush(flayout_t *layout)
+{
+  unsigned int i = 0;
+
+  for(; i < layout->size; i++)
+    free(layout->rows[i].breaks);
+
+  free(layout->rows);
+  layout->rows = NULL;
+  layout->size = 0;
+  layout->bytes = 0;
+}
+
+void flayout_destroy(flayout_t *layout)
+{
+  if(!layout)
+    return;
+
+  flayout_flush(layout);
+  free(layout);
+}
+
+static int flayout_grow(flayout_t *layout, unsigned int id)
+{
+  unsigned int size = layout->size ? layout->size : 256;
+  flayout_row_t *rows = NULL;
+
+  while(size <= id)
+    size *= 2;
+
+  rows = realloc(layout->rows, size * sizeof(flayout_row_t));
+  if(!rows)
+  {
+    perror("realloc");
+    return -1;
+  }
+
+  memset(rows + layout->size, 0, (size - layout->size) * sizeof(flayout_row_t));
+  layout->bytes += (size - layout->size) * sizeof(flayout_row_t);
+  layout->rows = rows;
+  layout->size = size;
+
+  return 0;
+}
+
+/* 
+ * greedy wrapping at spaces, a word wider than the line is cut. columns 
+ * are display columns, a wide character takes 2 and a mark none
+ */
+static void flayout_wrap(flayout_t *layout, flayout_row_t *row, 
+                         const char *desc, int width)
+{
+  unsigned int breaks[FLAYOUT_LINES];
+  unsigned int count = 0, cut = 0;
+  unsigned int start = 0, space = 0, i = 0, len = strlen(desc);
+  int cols = 0, n = 0, w = 0;
+
+  /* most rows are ascii and fit, they have no breaks */
+  if(len <= width && xwidth_ascii(desc, len) == len)
+    i = len;
+
+  for(; i < len; i += n)
+  {
+    n = 1;
+    w = 1;
+    if(desc[i] & 0x80)
+      n = xwidth_next(desc + i, len - i, &w);
+
+    if(desc[i] == ' ')
+      space = i;
+
+    cols += w;
+    if(cols <= width || desc[i] == ' ')
+      continue;
+
+    /* break after the last space of the line, or cut the word here */
+    if(space > start)
+      start = space + 1;
+    else
+      start = i;
+
+    while(desc[start] == ' ')
+      start++;
+
+    breaks[count++] = start;
+    if(count == FLAYOUT_LINES)
+    {
+      cut = 1;
+      break;
+    }
+
+    /* columns already taken on the new line */
+    cols = xwidth_strn(desc + start, i + n - start);
+    space = start;
+  }
+
+  /* 
+   * a trailing break would only hold spaces. the break a cut row stops at
+   * ends its last line, it is kept past count
+   */
+  if(count && !desc[breaks[count - 1]])
+    cut = 0;
+  if(count && (cut || !desc[breaks[count - 1]]))
+    count--;
+
+  if(count + cut > row->size)
+  {
+    unsigned int size = count + cut;
+    unsigned int *tmp = realloc(row->breaks, size * sizeof(unsigned int));
+    if(!tmp)
+    {
+      perror("realloc");
+      count = cut = 0;
+    }
+    else
+    {
+      layout->bytes += (size - row->size) * sizeof(unsigned int);
+      row->breaks = tmp;
+      row->size = size;
+    }
+  }
+
+  if(count + cut)
+    memcpy(row->breaks, breaks, (count + cut) * sizeof(unsigned int));
+  row->count = count;
+  row->cut = cut;
+  row->width = width;
+}
+
+const flayout_row_t *flayout_get(flayout_t *layout, unsigned int id,
+                                 const char *desc, int width)
+{
+  static flayout_row_t none;
+  flayout_row_t *row = NULL;
+
+  if(width <= 0 || width > 0xffff)
+    return &none;
+
+  if(id >= layout->size && flayout_grow(layout, id) < 0)
+    return &none;
+
+  row = &layout->rows[id];
+  if(row->width != width)
+    flayout_wrap(layout, row, desc, width);
+
+  return row;
+}
+
+int flayout_line(const flayout_row_t *row, const char *desc, int n, 
+                 unsigned int *start)
+{
+  unsigned int from = n ? row->breaks[n - 1] : 0;
+  unsigned int to = 0;
+
+  if(n < row->count || row->cut)
+    to = row->breaks[n];
+  else
+    to = from + strlen(desc + from);
+
+  while(to > from && desc[to - 1] == ' ')
+    to--;
+
+  *start = from;
+  return to - from;
+}
+
+void flayout_prune(flayout_t *layout, flayout_keep_f keep, void *ctx)
+{
+  unsigned int id = 0;
+
+  for(; id < layout->size; id++)
+  {
+    flayout_row_t *row = &layout->rows[id];
+
+    if(!row->size || keep(ctx, id))
+      continue;
+
+    free(row->breaks);
+    layout->bytes -= row->size * sizeof(unsigned int);
+    memset(row, 0, sizeof(flayout_row_t));
+  }
+}
+
+size_t flayout_bytes(flayout_t *layout)
+{
+  return layout->bytes;
+}
@@ -0,0 +1,308 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+
+#include "fnotes.h"
+
+fnotes_t *fnotes_create(fstore_t *store, unsigned int budget)
+{
+  const char *dir = getenv("TMPDIR");
+  char path[PATH_MAX];
+  fnotes_t *notes = NULL;
+
+  notes = malloc(sizeof(fnotes_t));
+  if(!notes)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(notes, 0, sizeof(fnotes_t));
+  notes->store = store;
+  notes->budget = budget;
+  notes->root = FSTORE_NONE;
+  notes->open = FSTORE_NONE;
+
+  /* the spool has no name once open, it goes away with the fd */
+  snprintf(path, sizeof(path), "%s/fhelper.notes.XXXXXX", 
+           dir && *dir ? dir : "/tmp");
+  notes->fd = mkstemp(path);
+  if(notes->fd < 0)
+  {
+    perror(path);
+    free(notes);
+    return NULL;
+  }
+  unlink(path);
+
+  if(xwriter_init(&notes->spool, notes->fd, 0) < 0)
+  {
+    close(notes->fd);
+    free(notes);
+    return NULL;
+  }
+
+  return notes;
+}
+
+void fnotes_destroy(fnotes_t *notes)
+{
+  if(!notes)
+    return;
+
+  xwriter_release(&notes->spool);
+  close(notes->fd);
+  free(notes->groups);
+  free(notes);
+}
+
+/* empty the spool, no group may point into it */
+static void fnotes_spool_reset(fnotes_t *notes)
+{
+  /* what is buffered belongs to the old groups too */
+  notes->spool.len = 0;
+  notes->spool.error = 0;
+  notes->end = 0;
+  if(ftruncate(notes->fd, 0) < 0 || lseek(notes->fd, 0, SEEK_SET) < 0)
+    perror("ftruncate");
+}
+
+void fnotes_flush(fnotes_t *notes)
+{
+  notes->root = FSTORE_NONE;
+  notes->kept = 0;
+  notes->open = FSTORE_NONE;
+  notes->count = 0;
+  notes->hidden = 0;
+  fnotes_spool_reset(notes);
+}
+
+void fnotes_prune(fnotes_t *notes)
+{
+  unsigned int i = 0, n = 0, open = FSTORE_NONE;
+
+  for(; i < notes->count; i++)
+  {
+    fnotes_group_t *group = &notes->groups[i];
+    finfo_t *row = fstore_row(notes->store, group->row);
+
+    /* an evicted placeholder takes its notes along */
+    if(!row || (row->flags & FINFO_DEAD))
+    {
+      notes->hidden -= group->count;
+      continue;
+    }
+
+    if(i == notes->open)
+      open = n;
+    notes->groups[n++] = *group;
+  }
+
+  notes->count = n;
+  notes->open = open;
+
+  /* no group is left in the spool, its bytes can go */
+  if(!notes->hidden && notes->open == FSTORE_NONE)
+    fnotes_spool_reset(notes);
+}
+
+/* a group with a placeholder row standing in for the notes of the root */
+static unsigned int fnotes_open(fnotes_t *notes, const finfo_t *first)
+{
+  fnotes_group_t *group = NULL;
+  finfo_t info = *first;
+  unsigned int row = FSTORE_NONE;
+
+  if(notes->count == notes->size)
+  {
+    unsigned int size = notes->size ? notes->size * 2 : 16;
+    fnotes_group_t *groups = realloc(notes->groups, 
+                                     size * sizeof(fnotes_group_t));
+    if(!groups)
+    {
+      perror("realloc");
+      return FSTORE_NONE;
+    }
+
+    notes->groups = groups;
+    notes->size = size;
+  }
+
+  /* at the place of the first hidden note, the text is never copied */
+  info.desc = FNOTES_DESC;
+  info.flag_id = XINTERN_NONE;
+  row = fstore_insert(notes->store, &info, 0);
+  if(row == FSTORE_NONE)
+    return FSTORE_NONE;
+  fstore_row(notes->store, row)->flags |= FINFO_VOLATILE;
+
+  group = &notes->groups[notes->count];
+  group->root = notes->root;
+  group->row = row;
+  group->count = 0;
+  group->start = group->end = notes->end;
+
+  notes->open = notes->count++;
+  return notes->open;
+}
+
+unsigned int fnotes_add(fnotes_t *notes, const char *line, 
+                        const finfo_t *info)
+{
+  fnotes_group_t *group = NULL;
+  size_t len = 0;
+
+  /* an error or a warning starts the budget of its notes */
+  if(info->type != INFO_TYPE_NOTE)
+  {
+    notes->root = fstore_insert(notes->store, info, 1);
+    notes->kept = 0;
+    notes->open = FSTORE_NONE;
+    return notes->root;
+  }
+
+  if(!notes->budget || notes->kept < notes->budget)
+  {
+    notes->kept++;
+    return fstore_insert(notes->store, info, 1);
+  }
+
+  if(notes->open == FSTORE_NONE && fnotes_open(notes, info) == FSTORE_NONE)
+    return FSTORE_NONE;
+
+  /*
+   * the spool keeps the line as it came, it is parsed again on expanding.
+   * the severity goes first, the rules may have given it another one,
+   * then 'k' for a known note or '-'
+   */
+  len = strlen(line);
+  if(xwriter_putc(&notes->spool, '0' + info->type) < 0
+     || xwriter_putc(&notes->spool, 
+                     info->flags & FINFO_KNOWN ? 'k' : '-') < 0
+     || xwriter_write(&notes->spool, line, len) < 0
+     || xwriter_putc(&notes->spool, '\n') < 0)
+    return FSTORE_NONE;
+
+  group = &notes->groups[notes->open];
+  notes->end += len + 3;
+  group->end = notes->end;
+  group->count++;
+  notes->hidden++;
+
+  return FSTORE_NONE;
+}
+
+/* the group of placeholder row id, the rows ascend with the groups */
+static fnotes_group_t *fnotes_group(fnotes_t *notes, unsigned int id)
+{
+  unsigned int low = 0, high = notes->count;
+
+  while(low < high)
+  {
+    unsigned int mid = low + (high - low) / 2;
+
+    if(notes->groups[mid].row < id)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if(low < notes->count && notes->groups[low].row == id)
+    return &notes->groups[low];
+
+  return NULL;
+}
+
+unsigned int fnotes_hidden(fnotes_t *notes, unsigned int id)
+{
+  finfo_t *info = fstore_row(notes->store, id);
+  fnotes_group_t *group = NULL;
+
+  if(!info || !(info->flags & FINFO_VOLATILE))
+    return 0;
+
+  group = fnotes_group(notes, id);
+  return group ? group->count : 0;
+}
+
+unsigned int fnotes_expand(fnotes_t *notes, unsigned int id)
+{
+  fnotes_group_t *group = fnotes_group(notes, id);
+  unsigned int first = fstore_count(notes->store);
+  size_t len = 0;
+  char *buf = NULL, *line = NULL, *next = NULL;
+
+  if(!group || !group->count)
+    return FSTORE_NONE;
+
+  len = group->end - group->start;
+  buf = malloc(len + 1);
+  if(!buf)
+  {
+    perror("malloc");
+    return FSTORE_NONE;
+  }
+
+  if(xwriter_flush(&notes->spool) < 0
+     || pread(notes->fd, buf, len, group->start) != len)
+  {
+    perror("pread");
+    free(buf);
+    return FSTORE_NONE;
+  }
+  buf[len] = '\0';
+
+  for(line = buf; line < buf + len; line = next + 1)
+  {
+    finfo_t info;
+
+    next = memchr(line, '\n', buf + len - line);
+    if(!next)
+      break;
+    *next = '\0';
+
+    if(fstore_parse(notes->store, line + 2, &info) < 0)
+      continue;
+    info.type = line[0] - '0';
+    if(line[1] == 'k')
+      info.flags |= FINFO_KNOWN;
+
+    /* where the placeholder was, under the root, not at the end */
+    fstore_insert_after(notes->store, &info, 1, id);
+  }
+  free(buf);
+
+  /* more notes of the root go behind a new placeholder */
+  notes->hidden -= group->count;
+  group->count = 0;
+  if(notes->open == group - notes->groups)
+    notes->open = FSTORE_NONE;
+  fstore_evict(notes->store, id);
+
+  return first < fstore_count(notes->store) ? first : FSTORE_NONE;
+}
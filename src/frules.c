@@ -0,0 +1,246 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "frules.h"
+
+#define FRULES_LINE_SIZE 1024
+
+static const char *action_names[] =
+{
+  "error", "warning", "note", "ignore", "info",
+};
+
+static const frule_action_t action_values[] =
+{
+  FRULE_ERROR, FRULE_WARN, FRULE_NOTE, FRULE_IGNORE, FRULE_NOTE,
+};
+
+/* the next word of *str, a "quoted" one may have spaces. NULL at the end */
+static char *frules_word(char **str)
+{
+  char *ptr = *str, *word = NULL;
+
+  while(isspace((unsigned char)*ptr))
+    ptr++;
+  if(!*ptr || *ptr == '#')
+    return NULL;
+
+  word = ptr;
+  while(*ptr && !isspace((unsigned char)*ptr))
+  {
+    /* the quotes are dropped, the text between them is kept */
+    if(*ptr == '"')
+    {
+      char *close = strchr(ptr + 1, '"');
+      if(!close)
+        return NULL;
+      memmove(ptr, ptr + 1, close - ptr - 1);
+      memmove(close - 1, close + 1, strlen(close + 1) + 1);
+      ptr = close - 1;
+      continue;
+    }
+    ptr++;
+  }
+
+  if(*ptr)
+    *ptr++ = '\0';
+  *str = ptr;
+  return word;
+}
+
+/* a rule is one glob over the joined fields, two for a directory path */
+static int frules_add(frules_t *rules, const char *path, const char *flag,
+                      const char *message)
+{
+  char glob[FRULES_LINE_SIZE * 2];
+  const char *wild = message ? strpbrk(message, "*?") : NULL;
+  int bit = rules->count, len = 0, dir = 0;
+
+  dir = path && *path && path[strlen(path) - 1] == '/';
+  len = snprintf(glob, sizeof(glob), "%s%s%s%c%s%c%s%s%s", 
+                 dir ? "*/" : "", path ? path : "*", dir ? "*" : "", 
+                 FRULES_SEP, flag ? flag : "*", FRULES_SEP,
+                 message && !wild ? "*" : "", message ? message : "*",
+                 message && !wild ? "*" : "");
+  if(len >= sizeof(glob) || xdfa_add(rules->dfa, glob, len, bit) < 0)
+    return -1;
+
+  /* a directory at the start of the path too */
+  if(dir && xdfa_add(rules->dfa, glob + 2, len - 2, bit) < 0)
+    return -1;
+
+  return 0;
+}
+
+/* "action field:pattern..." into a rule, return -1 if it is bad */
+static int frules_parse(frules_t *rules, char *line)
+{
+  const char *path = NULL, *flag = NULL, *message = NULL;
+  char *word = frules_word(&line);
+  int i = 0;
+
+  if(!word)
+    return 0;
+
+  for(; i < sizeof(action_names) / sizeof(action_names[0]); i++)
+  {
+    if(!strcmp(word, action_names[i]))
+      break;
+  }
+  if(i == sizeof(action_names) / sizeof(action_names[0]) 
+     || rules->count == FRULES_MAX)
+    return -1;
+
+  while((word = frules_word(&line)))
+  {
+    if(!strncmp(word, "path:", 5))
+      path = word + 5;
+    else if(!strncmp(word, "flag:", 5))
+      flag = word + 5;
+    else if(!strncmp(word, "message:", 8))
+      message = word + 8;
+    else
+      return -1;
+  }
+
+  if(frules_add(rules, path, flag, message) < 0)
+    return -1;
+
+  rules->actions[rules->count++] = action_values[i];
+  return 0;
+}
+
+frules_t *frules_load(const char *path)
+{
+  char line[FRULES_LINE_SIZE];
+  frules_t *rules = NULL;
+  FILE *fp = fopen(path, "r");
+  int n = 0;
+
+  if(!fp)
+  {
+    perror(path);
+    return NULL;
+  }
+
+  rules = malloc(sizeof(frules_t));
+  if(!rules)
+  {
+    perror("malloc");
+    fclose(fp);
+    return NULL;
+  }
+
+  memset(rules, 0, sizeof(frules_t));
+  rules->dfa = xdfa_create(FRULES_SEP);
+  if(!rules->dfa)
+    goto err;
+
+  while(fgets(line, sizeof(line), fp))
+  {
+    n++;
+    line[strcspn(line, "\r\n")] = '\0';
+    if(frules_parse(rules, line) < 0)
+    {
+      fprintf(stderr, "%s:%d: bad rule\n", path, n);
+      goto err;
+    }
+  }
+
+  if(xdfa_compile(rules->dfa) < 0)
+    goto err;
+
+  fclose(fp);
+  return rules;
+
+err:
+  fclose(fp);
+  frules_destroy(rules);
+  return NULL;
+}
+
+void frules_destroy(frules_t *rules)
+{
+  if(!rules)
+    return;
+
+  xdfa_destroy(rules->dfa);
+  free(rules);
+}
+
+size_t frules_bytes(frules_t *rules)
+{
+  return sizeof(frules_t) + (rules->dfa ? xdfa_bytes(rules->dfa) : 0);
+}
+
+frule_action_t frules_match(frules_t *rules, fstore_t *store, 
+                            const finfo_t *info)
+{
+  xdfa_t *dfa = rules->dfa;
+  const char *path = fstore_path(store, info);
+  const char *flag = fstore_flag(store, info);
+  unsigned int state = xdfa_start(dfa);
+  unsigned long long matched = 0;
+
+  /* one pass over path \1 flag \1 description */
+  state = xdfa_feed(dfa, state, path, strlen(path));
+  state = xdfa_step(dfa, state, FRULES_SEP);
+  if(flag)
+    state = xdfa_feed(dfa, state, flag, strlen(flag));
+  state = xdfa_step(dfa, state, FRULES_SEP);
+  state = xdfa_feed(dfa, state, info->desc, strlen(info->desc));
+
+  /* the rules are the bits in file order */
+  matched = xdfa_accept(dfa, state);
+  if(!matched)
+    return FRULE_NONE;
+
+  return rules->actions[__builtin_ctzll(matched)];
+}
+
+int frules_apply(frules_t *rules, fstore_t *store, finfo_t *info)
+{
+  frule_action_t action = frules_match(rules, store, info);
+
+  if(info->type != INFO_TYPE_NOTE)
+    rules->ignoring = action == FRULE_IGNORE;
+  else if(action == FRULE_NONE && rules->ignoring)
+    action = FRULE_IGNORE;
+
+  if(action == FRULE_IGNORE)
+  {
+    rules->ignored++;
+    return -1;
+  }
+
+  if(action != FRULE_NONE && action != info->type)
+  {
+    info->type = action;
+    rules->changed++;
+  }
+
+  return 0;
+}
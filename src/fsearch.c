@@ -0,0 +1,205 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "fsearch.h"
+
+#define FSEARCH_INIT_IDS 256
+
+fsearch_t *fsearch_create(fstore_t *store, fsort_t sort)
+{
+  fsearch_t *search = malloc(sizeof(fsearch_t));
+  if(!search)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(search, 0, sizeof(fsearch_t));
+  search->store = store;
+  search->subset = fstore_subset_create(store, sort);
+  if(!search->subset)
+  {
+    free(search);
+    return NULL;
+  }
+
+  return search;
+}
+
+void fsearch_destroy(fsearch_t *search)
+{
+  if(!search)
+    return;
+
+  fstore_subset_destroy(search->store, search->subset);
+  free(search->ids);
+  free(search);
+}
+
+static int fsearch_match(fsearch_t *search, unsigned int id)
+{
+  finfo_t *row = fstore_row(search->store, id);
+
+  if(!row || (row->flags & FINFO_DEAD))
+    return 0;
+
+  search->checked++;
+  if(search->icase)
+    return strcasestr(row->desc, search->query) != NULL;
+
+  return strstr(row->desc, search->query) != NULL;
+}
+
+static int fsearch_add(fsearch_t *search, unsigned int id)
+{
+  if(search->count == search->size)
+  {
+    unsigned int size = search->size ? search->size * 2 : FSEARCH_INIT_IDS;
+    unsigned int *ids = realloc(search->ids, size * sizeof(unsigned int));
+    if(!ids)
+    {
+      perror("realloc");
+      return -1;
+    }
+
+    search->ids = ids;
+    search->size = size;
+  }
+
+  search->ids[search->count++] = id;
+  xskiplist_insert(search->subset, id);
+  return 0;
+}
+
+/* the last matches are a superset of the new ones, drop the others */
+static void fsearch_narrow(fsearch_t *search)
+{
+  unsigned int i = 0, n = 0;
+
+  for(; i < search->count; i++)
+  {
+    unsigned int id = search->ids[i];
+
+    if(fsearch_match(search, id))
+      search->ids[n++] = id;
+    else
+      xskiplist_remove(search->subset, id);
+  }
+
+  search->count = n;
+}
+
+/* check the rows of the shortest posting list of the query */
+static void fsearch_scan(fsearch_t *search)
+{
+  fstore_t *store = search->store;
+  const unsigned int *ids = NULL;
+  long count = xtrigram_candidates(store->grams, search->query, search->len,
+                                   &ids);
+  long i = 0;
+
+  for(i = 0; i < count; i++)
+  {
+    if(fsearch_match(search, ids[i]))
+      fsearch_add(search, ids[i]);
+  }
+}
+
+long fsearch_set(fsearch_t *search, const char *query, int len)
+{
+  char old[FSEARCH_MAX];
+  int old_icase = search->icase, narrow = 0, i = 0;
+
+  if(len < 0)
+    len = strlen(query);
+  if(len >= FSEARCH_MAX)
+    len = FSEARCH_MAX - 1;
+
+  /* the rows which came meanwhile are still searched for the old query */
+  fsearch_update(search);
+
+  memcpy(old, search->query, search->len + 1);
+  narrow = fsearch_active(search) && memmem(query, len, old, search->len);
+
+  memcpy(search->query, query, len);
+  search->query[len] = '\0';
+  search->len = len;
+  search->icase = 1;
+  for(; i < len; i++)
+  {
+    if(isupper((unsigned char)query[i]))
+      search->icase = 0;
+  }
+
+  /* 
+   * a text with the new query has the old one in it, in any case if the 
+   * old search ignored the case
+   */
+  if(narrow && search->icase && !old_icase)
+    narrow = 0;
+
+  search->checked = 0;
+  if(narrow)
+    fsearch_narrow(search);
+  else
+  {
+    search->count = 0;
+    xskiplist_flush(search->subset);
+    if(fsearch_active(search))
+      fsearch_scan(search);
+  }
+
+  search->next = fstore_count(search->store);
+  return fsearch_count(search);
+}
+
+unsigned int fsearch_update(fsearch_t *search)
+{
+  fstore_t *store = search->store;
+  unsigned int count = search->count;
+
+  /* the store was flushed, the subset is empty already */
+  if(search->next > fstore_count(store))
+  {
+    search->count = 0;
+    search->next = 0;
+    count = 0;
+  }
+
+  if(!fsearch_active(search))
+  {
+    search->next = fstore_count(store);
+    return 0;
+  }
+
+  for(; search->next < fstore_count(store); search->next++)
+  {
+    if(fsearch_match(search, search->next))
+      fsearch_add(search, search->next);
+  }
+
+  return search->count - count;
+}
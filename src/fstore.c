@@ -0,0 +1,891 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ctype.h>
+
+#include "xdebug.h"
+#include "fstore.h"
+
+#define FSTORE_INIT_ROWS 1024
+
+#define TYPE_ERROR_STR  "error"
+#define TYPE_WARN_STR   "warning"
+#define TYPE_NOTE_STR   "note"
+
+info_type_t info_type_get(const char *typestr)
+{
+  if(!typestr)
+    return INFO_TYPE_UNKNOWN;
+
+  if(strstr(typestr, TYPE_ERROR_STR))
+    return INFO_TYPE_ERROR;
+
+  if(strstr(typestr, TYPE_WARN_STR))
+    return INFO_TYPE_WARN;
+
+  if(strstr(typestr, TYPE_NOTE_STR))
+    return INFO_TYPE_NOTE;
+
+  return INFO_TYPE_UNKNOWN;
+}
+
+const char *info_type_name(info_type_t type)
+{
+  static const char * const type_names[] =
+  {
+    TYPE_ERROR_STR, TYPE_WARN_STR, TYPE_NOTE_STR, "unknown"
+  };
+
+  if(type > INFO_TYPE_UNKNOWN)
+    type = INFO_TYPE_UNKNOWN;
+
+  return type_names[type];
+}
+
+const char *fsort_name(fsort_t sort)
+{
+  static const char * const sort_names[] =
+  {
+    "default", "file", "severity", "flag"
+  };
+
+  if(sort >= FSORT_MAX)
+    sort = FSORT_DEFAULT;
+
+  return sort_names[sort];
+}
+
+/**************** sort orders, ties are broken by arrival ****************/
+static int fsort_id(fstore_t *store, unsigned int id1, unsigned int id2)
+{
+  unsigned int seq1 = store->rows[id1].seq, seq2 = store->rows[id2].seq;
+
+  if(seq1 != seq2)
+    return (seq1 > seq2) - (seq1 < seq2);
+
+  return (id1 > id2) - (id1 < id2);
+}
+
+static int fsort_default_cmp(void *ctx, unsigned int id1, unsigned int id2)
+{
+  fstore_t *store = (fstore_t *)ctx;
+  int other1 = store->rows[id1].type != INFO_TYPE_ERROR;
+  int other2 = store->rows[id2].type != INFO_TYPE_ERROR;
+
+  if(other1 != other2)
+    return other1 - other2;
+
+  return fsort_id(store, id1, id2);
+}
+
+static int fsort_severity_cmp(void *ctx, unsigned int id1, unsigned int id2)
+{
+  fstore_t *store = (fstore_t *)ctx;
+  int type1 = store->rows[id1].type;
+  int type2 = store->rows[id2].type;
+
+  if(type1 != type2)
+    return type1 - type2;
+
+  return fsort_id(store, id1, id2);
+}
+
+static int fsort_path_cmp(fstore_t *store, unsigned int path1, 
+                          unsigned int path2)
+{
+  if(path1 == path2)
+    return 0;
+
+  return strcmp(xintern_str(store->paths, path1),
+                xintern_str(store->paths, path2));
+}
+
+static int fsort_file_cmp(void *ctx, unsigned int id1, unsigned int id2)
+{
+  fstore_t *store = (fstore_t *)ctx;
+  finfo_t *row1 = &store->rows[id1];
+  finfo_t *row2 = &store->rows[id2];
+
+  if(row1->path_id != row2->path_id)
+    return fsort_path_cmp(store, row1->path_id, row2->path_id);
+
+  if(row1->line != row2->line)
+    return (row1->line > row2->line) - (row1->line < row2->line);
+
+  if(row1->offset != row2->offset)
+    return (row1->offset > row2->offset) - (row1->offset < row2->offset);
+
+  return fsort_id(store, id1, id2);
+}
+
+static int fsort_flag_id_cmp(fstore_t *store, unsigned int flag1, 
+                             unsigned int flag2)
+{
+  if(flag1 == flag2)
+    return 0;
+
+  /* rows without a flag go last */
+  if(flag1 == XINTERN_NONE || flag2 == XINTERN_NONE)
+    return flag1 == XINTERN_NONE ? 1 : -1;
+
+  return strcmp(xintern_str(store->flags, flag1),
+                xintern_str(store->flags, flag2));
+}
+
+static int fsort_flag_cmp(void *ctx, unsigned int id1, unsigned int id2)
+{
+  fstore_t *store = (fstore_t *)ctx;
+  int ret = fsort_flag_id_cmp(store, store->rows[id1].flag_id, 
+                              store->rows[id2].flag_id);
+
+  if(ret)
+    return ret;
+
+  return fsort_file_cmp(ctx, id1, id2);
+}
+
+static const xskiplist_cmp_f fsort_cmps[FSORT_MAX] =
+{
+  fsort_default_cmp,
+  fsort_file_cmp,
+  fsort_severity_cmp,
+  fsort_flag_cmp,
+};
+
+/* weights summed by the indexes, see FSTORE_SUM_XXX */
+static void fstore_weigh(void *ctx, unsigned int id, unsigned int *weights)
+{
+  fstore_t *store = (fstore_t *)ctx;
+
+  weights[FSTORE_SUM_ERRORS] = store->rows[id].type == INFO_TYPE_ERROR;
+  weights[FSTORE_SUM_LINES] = 1;
+  if(store->height)
+    weights[FSTORE_SUM_LINES] = store->height(store->height_ctx, store, id);
+}
+
+/************************************************************************/
+fstore_t *fstore_create(xintern_derive_f shrink)
+{
+  int i = 0;
+  fstore_t *store = malloc(sizeof(fstore_t));
+  if(!store)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(store, 0, sizeof(fstore_t));
+  xarena_init(&store->text);
+
+  store->paths = xintern_create(shrink);
+  store->flags = xintern_create(NULL);
+  store->templates = xintern_create(NULL);
+  if(!store->paths || !store->flags || !store->templates)
+    goto err;
+
+  for(i = 0; i < FSORT_MAX; i++)
+  {
+    store->index[i] = xskiplist_create(fsort_cmps[i], store);
+    if(!store->index[i])
+      goto err;
+    xskiplist_weigh(store->index[i], fstore_weigh);
+  }
+
+  store->grams = xtrigram_create();
+  store->tree = ftree_create();
+  if(!store->grams || !store->tree)
+    goto err;
+
+  return store;
+
+err:
+  fstore_destroy(store);
+  return NULL;
+}
+
+void fstore_destroy(fstore_t *store)
+{
+  int i = 0;
+
+  if(!store)
+    return;
+
+  for(i = 0; i < FSORT_MAX; i++)
+    xskiplist_destroy(store->index[i]);
+  for(i = 0; i < FSTORE_MAX_SUBSETS; i++)
+    xskiplist_destroy(store->subsets[i]);
+
+  xtrigram_destroy(store->grams);
+  ftree_destroy(store->tree);
+  xintern_destroy(store->paths);
+  xintern_destroy(store->flags);
+  xintern_destroy(store->templates);
+  xbitset_release(&store->alive);
+  xarena_flush(&store->text);
+  free(store->rows);
+  free(store);
+}
+
+void fstore_flush(fstore_t *store)
+{
+  int i = 0;
+
+  if(!store)
+    return;
+
+  for(i = 0; i < FSORT_MAX; i++)
+    xskiplist_flush(store->index[i]);
+  for(i = 0; i < FSTORE_MAX_SUBSETS; i++)
+  {
+    if(store->subsets[i])
+      xskiplist_flush(store->subsets[i]);
+  }
+
+  xtrigram_flush(store->grams);
+  ftree_flush(store->tree);
+  xintern_flush(store->paths);
+  xintern_flush(store->flags);
+  xintern_flush(store->templates);
+  xbitset_zero(&store->alive);
+  xarena_flush(&store->text);
+
+  store->count = 0;
+  store->live = 0;
+  store->evicted = 0;
+  store->dead_text = 0;
+  memset(store->type_count, 0, sizeof(store->type_count));
+}
+
+/* find the trailing [-Wxxx] of a description */
+static unsigned int fstore_parse_flag(fstore_t *store, const char *desc)
+{
+  int len = strlen(desc);
+  const char *open = NULL;
+
+  while(len > 0 && desc[len - 1] == ' ')
+    len--;
+
+  if(len < 3 || desc[len - 1] != ']')
+    return XINTERN_NONE;
+
+  open = memrchr(desc, '[', len);
+  if(!open || open[1] != '-')
+    return XINTERN_NONE;
+
+  return xintern_add(store->flags, open + 1, desc + len - 1 - (open + 1));
+}
+
+/*
+ * only take care of such error/warning lines:
+ * /xxx/xxx.c:73:27: warning: unused variable 'list' [-Wunused-variable]
+ * Format: file.c:lineno:offset:reasonDesc [-Wreason]
+ */
+#define PATH_INDEX       0
+#define LINE_NUM_INDEX   1
+#define OFFSET_NUM_INDEX 2
+#define INFO_TYPE_INDEX  3
+#define INFO_DESC_INDEX  4
+int fstore_parse(fstore_t *store, const char *line, finfo_t *info)
+{
+  const char *fields[INFO_DESC_INDEX + 1] = {NULL};
+  int lens[INFO_DESC_INDEX] = {0};
+  int i = 0;
+
+  fields[PATH_INDEX] = line;
+  for(i = 0; i < INFO_DESC_INDEX; i++)
+  {
+    const char *colon = NULL;
+
+    /* file.c:lineno: type: desc has no offset */
+    if(i == OFFSET_NUM_INDEX && !isdigit((unsigned char)*fields[i]))
+    {
+      fields[i + 1] = fields[i];
+      fields[i] = "0";
+      continue;
+    }
+
+    colon = strchr(fields[i], ':');
+    if(!colon)
+      return -1;
+
+    lens[i] = colon - fields[i];
+    fields[i + 1] = colon + 1;
+  }
+
+  /* make: *** [Makefile:12: all] and the like */
+  if(!isdigit((unsigned char)*fields[LINE_NUM_INDEX]))
+    return -1;
+
+  info->type = info_type_get(strndupa(fields[INFO_TYPE_INDEX],
+                                      lens[INFO_TYPE_INDEX]));
+  info->path_id = xintern_add(store->paths, fields[PATH_INDEX], lens[PATH_INDEX]);
+  if(info->path_id == XINTERN_NONE)
+    return -1;
+
+  info->line = strtoul(fields[LINE_NUM_INDEX], NULL, 10);
+  info->offset = strtoul(fields[OFFSET_NUM_INDEX], NULL, 10);
+  info->desc = fields[INFO_DESC_INDEX] + strspn(fields[INFO_DESC_INDEX], " ");
+  info->flag_id = fstore_parse_flag(store, info->desc);
+  info->flags = 0;
+
+  return 0;
+}
+
+int fstore_templatize(const char *desc, char *buf, int size)
+{
+  const unsigned char *str = (const unsigned char *)desc;
+  int len = 0;
+
+  while(*str && len < size - 8)
+  {
+    const char *close = NULL;
+    int open = 1;
+
+    /* 'x', "x", `x' and the utf-8 quotes gcc uses */
+    if(*str == '\'' || *str == '`')
+      close = "'";
+    else if(*str == '"')
+      close = "\"";
+    else if(str[0] == 0xe2 && str[1] == 0x80 && str[2] == 0x98)
+    {
+      close = "\xe2\x80\x99";
+      open = 3;
+    }
+
+    if(close)
+    {
+      const char *end = strstr((const char *)str + open, close);
+
+      if(end)
+      {
+        memcpy(buf + len, str, open);
+        len += open;
+        buf[len++] = '*';
+        memcpy(buf + len, end, strlen(close));
+        len += strlen(close);
+        str = (const unsigned char *)end + strlen(close);
+        continue;
+      }
+    }
+
+    if(isdigit(*str) && (str == (const unsigned char *)desc 
+                         || !(isalnum(str[-1]) || str[-1] == '_')))
+    {
+      while(isdigit(*str))
+        str++;
+      buf[len++] = 'N';
+      continue;
+    }
+
+    buf[len++] = *str++;
+  }
+
+  buf[len] = '\0';
+  return len;
+}
+
+unsigned int fstore_insert(fstore_t *store, const finfo_t *info, int copy)
+{
+  return fstore_insert_after(store, info, copy, FSTORE_NONE);
+}
+
+unsigned int fstore_insert_after(fstore_t *store, const finfo_t *info, 
+                                 int copy, unsigned int after)
+{
+  char tmpl[FSTORE_TEMPLATE_SIZE];
+  unsigned int id = store->count;
+  finfo_t *row = NULL;
+  int i = 0;
+
+  if(id == FSTORE_NONE)
+    return FSTORE_NONE;
+
+  if(store->count == store->size)
+  {
+    unsigned int size = store->size ? store->size * 2 : FSTORE_INIT_ROWS;
+    finfo_t *rows = realloc(store->rows, size * sizeof(finfo_t));
+    if(!rows)
+    {
+      perror("realloc");
+      return FSTORE_NONE;
+    }
+
+    store->rows = rows;
+    store->size = size;
+  }
+
+  row = &store->rows[id];
+  *row = *info;
+  row->flags = info->flags & FINFO_KNOWN;
+  row->seq = after < id ? store->rows[after].seq : id;
+  if(copy)
+  {
+    row->desc = xarena_strndup(&store->text, info->desc, strlen(info->desc));
+    if(!row->desc)
+      return FSTORE_NONE;
+    row->flags |= FINFO_ARENA;
+  }
+
+  if(row->type > INFO_TYPE_UNKNOWN)
+    row->type = INFO_TYPE_UNKNOWN;
+
+  row->tmpl_id = xintern_add(store->templates, tmpl, 
+                             fstore_templatize(row->desc, tmpl, sizeof(tmpl)));
+  if(xbitset_set(&store->alive, id) < 0)
+    return FSTORE_NONE;
+
+  store->count++;
+  store->live++;
+  store->type_count[row->type]++;
+
+  for(i = 0; i < FSORT_MAX; i++)
+    xskiplist_insert(store->index[i], id);
+
+  if(ftree_add(store->tree, row->path_id, fstore_path(store, row), 
+               row->type) == FTREE_NONE)
+    perror("ftree_add");
+
+  /* a row missing from the trigrams would never be found */
+  if(xtrigram_add(store->grams, id, row->desc, strlen(row->desc)) < 0)
+    perror("xtrigram_add");
+
+  return id;
+}
+
+/* move the live arena texts into a fresh arena, drops the dead ones */
+static void fstore_compact_text(fstore_t *store)
+{
+  xarena_t text;
+  unsigned int id = 0;
+
+  xarena_init(&text);
+  for(; id < store->count; id++)
+  {
+    finfo_t *row = &store->rows[id];
+    const char *desc = NULL;
+
+    if(!(row->flags & FINFO_ARENA) || (row->flags & FINFO_DEAD))
+      continue;
+
+    desc = xarena_strndup(&text, row->desc, strlen(row->desc));
+    if(!desc)
+    {
+      xarena_flush(&text);
+      return;
+    }
+    row->desc = desc;
+  }
+
+  xarena_flush(&store->text);
+  store->text = text;
+  store->dead_text = 0;
+}
+
+int fstore_evict(fstore_t *store, unsigned int id)
+{
+  finfo_t *row = fstore_row(store, id);
+  int i = 0;
+
+  if(!row || (row->flags & FINFO_DEAD))
+    return -1;
+
+  for(i = 0; i < FSORT_MAX; i++)
+    xskiplist_remove(store->index[i], id);
+  for(i = 0; i < FSTORE_MAX_SUBSETS; i++)
+  {
+    if(store->subsets[i])
+      xskiplist_remove(store->subsets[i], id);
+  }
+
+  row->flags |= FINFO_DEAD;
+  xbitset_clear(&store->alive, id);
+  store->live--;
+  store->evicted++;
+  store->type_count[row->type]--;
+  ftree_remove(store->tree, row->path_id, row->type);
+
+  if(row->flags & FINFO_ARENA)
+    store->dead_text += strlen(row->desc) + 1;
+
+  return 0;
+}
+
+size_t fstore_bytes(fstore_t *store)
+{
+  size_t bytes = sizeof(fstore_t);
+  int i = 0;
+
+  bytes += store->size * sizeof(finfo_t);
+  bytes += xarena_bytes(&store->text);
+  bytes += xintern_bytes(store->paths) + xintern_bytes(store->flags);
+  bytes += xintern_bytes(store->templates) + xbitset_bytes(&store->alive);
+
+  for(i = 0; i < FSORT_MAX; i++)
+    bytes += xskiplist_bytes(store->index[i]);
+  for(i = 0; i < FSTORE_MAX_SUBSETS; i++)
+  {
+    if(store->subsets[i])
+      bytes += xskiplist_bytes(store->subsets[i]);
+  }
+  bytes += xtrigram_bytes(store->grams) + ftree_bytes(store->tree);
+
+  return bytes;
+}
+
+xskiplist_t *fstore_subset_create(fstore_t *store, fsort_t sort)
+{
+  int i = 0;
+
+  for(; i < FSTORE_MAX_SUBSETS && store->subsets[i]; i++)
+    ;
+
+  if(i == FSTORE_MAX_SUBSETS || sort >= FSORT_MAX)
+    return NULL;
+
+  store->subsets[i] = xskiplist_create(fsort_cmps[sort], store);
+  if(store->subsets[i])
+    xskiplist_weigh(store->subsets[i], fstore_weigh);
+
+  return store->subsets[i];
+}
+
+void fstore_subset_destroy(fstore_t *store, xskiplist_t *subset)
+{
+  int i = 0;
+
+  if(!subset)
+    return;
+
+  for(; i < FSTORE_MAX_SUBSETS; i++)
+  {
+    if(store->subsets[i] == subset)
+      store->subsets[i] = NULL;
+  }
+
+  xskiplist_destroy(subset);
+}
+
+/* bottom-up merge, runs which are in order already are not merged */
+int fstore_sort_ids(fstore_t *store, fsort_t sort, unsigned int *ids,
+                    unsigned int count)
+{
+  xskiplist_cmp_f cmp = fsort_cmps[sort < FSORT_MAX ? sort : FSORT_DEFAULT];
+  unsigned int *tmp = NULL, *src = ids, *dst = NULL;
+  unsigned int width = 1;
+
+  if(count < 2)
+    return 0;
+
+  tmp = malloc(count * sizeof(unsigned int));
+  if(!tmp)
+  {
+    perror("malloc");
+    return -1;
+  }
+
+  for(dst = tmp; width < count; width *= 2)
+  {
+    unsigned int lo = 0, *swap = NULL;
+
+    for(; lo < count; lo += 2 * width)
+    {
+      unsigned int mid = lo + width < count ? lo + width : count;
+      unsigned int hi = mid + width < count ? mid + width : count;
+      unsigned int i = lo, j = mid, k = lo;
+
+      if(mid == hi || cmp(store, src[mid - 1], src[mid]) < 0)
+      {
+        memcpy(dst + lo, src + lo, (hi - lo) * sizeof(unsigned int));
+        continue;
+      }
+
+      while(i < mid && j < hi)
+        dst[k++] = cmp(store, src[j], src[i]) < 0 ? src[j++] : src[i++];
+      while(i < mid)
+        dst[k++] = src[i++];
+      while(j < hi)
+        dst[k++] = src[j++];
+    }
+
+    swap = src;
+    src = dst;
+    dst = swap;
+  }
+
+  if(src != ids)
+    memcpy(ids, src, count * sizeof(unsigned int));
+
+  free(tmp);
+  return 0;
+}
+
+void fstore_subset_sort(fstore_t *store, xskiplist_t *subset, fsort_t sort)
+{
+  unsigned int count = xskiplist_count(subset), i = 0;
+  unsigned int *ids = NULL;
+  xsknode_t *node = NULL;
+
+  if(sort >= FSORT_MAX || subset->cmp == fsort_cmps[sort])
+    return;
+
+  ids = malloc((count ? count : 1) * sizeof(unsigned int));
+  if(!ids)
+  {
+    perror("malloc");
+    return;
+  }
+
+  for(node = xskiplist_first(subset); node; node = xskiplist_next(node))
+    ids[i++] = node->id;
+
+  subset->cmp = fsort_cmps[sort];
+  if(fstore_sort_ids(store, sort, ids, count) == 0)
+  {
+    xskiplist_build(subset, ids, count);
+  }
+  else
+  {
+    xskiplist_flush(subset);
+    for(i = 0; i < count; i++)
+      xskiplist_insert(subset, ids[i]);
+  }
+
+  free(ids);
+}
+
+fsort_t fstore_index_sort(fstore_t *store, xskiplist_t *index)
+{
+  int i = 0;
+
+  for(; i < FSORT_MAX; i++)
+  {
+    if(index->cmp == fsort_cmps[i])
+      return i;
+  }
+
+  return FSORT_DEFAULT;
+}
+
+/* rows still alive keep their trigrams */
+static int fstore_alive(void *ctx, unsigned int id)
+{
+  fstore_t *store = (fstore_t *)ctx;
+
+  return !(store->rows[id].flags & FINFO_DEAD);
+}
+
+/* the oldest live row of type, severity order is (type, id) */
+static unsigned int fstore_oldest(fstore_t *store, info_type_t type)
+{
+  unsigned long rank = 0;
+  int i = 0;
+  xsknode_t *node = NULL;
+
+  if(!store->type_count[type])
+    return FSTORE_NONE;
+
+  for(i = 0; i < type; i++)
+    rank += store->type_count[i];
+
+  node = xskiplist_at(store->index[FSORT_SEVERITY], rank);
+  return node ? node->id : FSTORE_NONE;
+}
+
+unsigned int fstore_trim(fstore_t *store, size_t budget)
+{
+  static const info_type_t victims[] =
+  {
+    INFO_TYPE_NOTE, INFO_TYPE_UNKNOWN, INFO_TYPE_WARN
+  };
+  unsigned int evicted = 0;
+  size_t bytes = 0, low = 0;
+  int i = 0;
+
+  if(!budget || (bytes = fstore_bytes(store)) <= budget)
+    return 0;
+
+  /* go a bit below the budget, don't evict on every insert */
+  low = budget - budget / 8;
+  for(i = 0; i < ARRAY_SIZE(victims) && bytes > low; i++)
+  {
+    unsigned int id = FSTORE_NONE;
+
+    while(bytes > low && (id = fstore_oldest(store, victims[i])) != FSTORE_NONE)
+    {
+      finfo_t *row = &store->rows[id];
+      size_t freed = (sizeof(xsknode_t) + sizeof(xsklink_t)) * FSORT_MAX;
+      size_t len = strlen(row->desc);
+
+      /* a posting per trigram at most, given back by the compaction */
+      freed += len * sizeof(unsigned int);
+      if(row->flags & FINFO_ARENA)
+        freed += len + 1;
+
+      fstore_evict(store, id);
+      evicted++;
+      bytes = bytes > freed ? bytes - freed : 0;
+    }
+  }
+
+  if(evicted)
+    xtrigram_compact(store->grams, fstore_alive, store);
+
+  /* dead texts are only given back by moving the live ones */
+  if(store->dead_text > xarena_used(&store->text) / 2
+     || (store->dead_text && fstore_bytes(store) > budget))
+    fstore_compact_text(store);
+
+  return evicted;
+}
+
+unsigned int fstore_add_line(fstore_t *store, const char *line)
+{
+  finfo_t info;
+
+  if(fstore_parse(store, line, &info) < 0)
+    return FSTORE_NONE;
+
+  return fstore_insert(store, &info, 1);
+}
+
+const char *fstore_path(fstore_t *store, const finfo_t *info)
+{
+  return xintern_str(store->paths, info->path_id);
+}
+
+const char *fstore_path_alias(fstore_t *store, const finfo_t *info)
+{
+  return xintern_alias(store->paths, info->path_id);
+}
+
+const char *fstore_flag(fstore_t *store, const finfo_t *info)
+{
+  if(info->flag_id == XINTERN_NONE)
+    return NULL;
+
+  return xintern_str(store->flags, info->flag_id);
+}
+
+const char *fstore_template(fstore_t *store, const finfo_t *info)
+{
+  return xintern_str(store->templates, info->tmpl_id);
+}
+
+long fstore_next_error(fstore_t *store, xskiplist_t *index, unsigned long rank)
+{
+  /* the errors up to rank, the next one is where the sum grows */
+  return xskiplist_seek(index, FSTORE_SUM_ERRORS, 
+                        xskiplist_sum(index, FSTORE_SUM_ERRORS, rank + 1));
+}
+
+/* files are runs in these orders, the end of a run is searched */
+static int fstore_file_before(void *ctx, unsigned int id, const void *key)
+{
+  fstore_t *store = (fstore_t *)ctx;
+  const finfo_t *row = key;
+
+  return fsort_path_cmp(store, store->rows[id].path_id, row->path_id) <= 0;
+}
+
+static int fstore_flag_file_before(void *ctx, unsigned int id, const void *key)
+{
+  fstore_t *store = (fstore_t *)ctx;
+  const finfo_t *row = key;
+  int ret = fsort_flag_id_cmp(store, store->rows[id].flag_id, row->flag_id);
+
+  if(ret)
+    return ret < 0;
+
+  return fstore_file_before(ctx, id, key);
+}
+
+long fstore_next_file(fstore_t *store, xskiplist_t *index, unsigned long rank)
+{
+  xsknode_t *node = xskiplist_at(index, rank);
+  unsigned int path_id = 0;
+  long next = -1;
+
+  if(!node)
+    return -1;
+
+  switch(fstore_index_sort(store, index))
+  {
+    case FSORT_FILE:
+      next = xskiplist_search(index, fstore_file_before, &store->rows[node->id]);
+      break;
+    case FSORT_FLAG:
+      next = xskiplist_search(index, fstore_flag_file_before, 
+                              &store->rows[node->id]);
+      break;
+    default:
+      /* 
+       * arrival orders keep no file key, walk the current run. it is short
+       * for interleaved output but one file flooding the index makes it O(n)
+       */
+      path_id = store->rows[node->id].path_id;
+      for(next = rank; node && store->rows[node->id].path_id == path_id; next++)
+        node = xskiplist_next(node);
+      if(!node)
+        next = -1;
+      break;
+  }
+
+  if(next >= xskiplist_count(index))
+    return -1;
+
+  return next;
+}
+
+void fstore_set_height(fstore_t *store, fstore_height_f height, void *ctx)
+{
+  int i = 0;
+
+  store->height = height;
+  store->height_ctx = ctx;
+  for(i = 0; i < FSORT_MAX; i++)
+    xskiplist_weigh(store->index[i], fstore_weigh);
+  for(i = 0; i < FSTORE_MAX_SUBSETS; i++)
+  {
+    if(store->subsets[i])
+      xskiplist_weigh(store->subsets[i], fstore_weigh);
+  }
+}
+
+unsigned long long fstore_lines_above(fstore_t *store, xskiplist_t *index, 
+                                      unsigned long rank)
+{
+  return xskiplist_sum(index, FSTORE_SUM_LINES, rank);
+}
+
+unsigned long long fstore_lines(fstore_t *store, xskiplist_t *index)
+{
+  return index->sum[FSTORE_SUM_LINES];
+}
+
+long fstore_row_at_line(fstore_t *store, xskiplist_t *index, 
+                        unsigned long long line)
+{
+  return xskiplist_seek(index, FSTORE_SUM_LINES, line);
+}
@@ -0,0 +1,468 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ftree.h"
+
+#define FTREE_INIT_SIZE 64
+#define FTREE_MAX_DEPTH 256
+
+static unsigned int ftree_hash(unsigned int parent, unsigned int name)
+{
+  return (parent * 0x9e3779b1u) ^ (name * 0x85ebca6bu);
+}
+
+/* the slot of (parent, name) or the empty one to insert it */
+static unsigned int *ftree_slot(ftree_t *tree, unsigned int parent,
+                                unsigned int name)
+{
+  unsigned int i = ftree_hash(parent, name) & tree->slot_mask;
+
+  while(tree->slots[i])
+  {
+    ftree_node_t *node = &tree->nodes[tree->slots[i] - 1];
+    if(node->parent == parent && node->name == name)
+      break;
+
+    i = (i + 1) & tree->slot_mask;
+  }
+
+  return &tree->slots[i];
+}
+
+/* nodes for size, the slots stay under 1/2 full */
+static int ftree_grow(ftree_t *tree, unsigned int size)
+{
+  ftree_node_t *nodes = realloc(tree->nodes, size * sizeof(ftree_node_t));
+  unsigned int *slots = NULL;
+  unsigned int i = 0;
+
+  if(!nodes)
+  {
+    perror("realloc");
+    return -1;
+  }
+  tree->nodes = nodes;
+
+  slots = calloc(size * 2, sizeof(unsigned int));
+  if(!slots)
+  {
+    perror("calloc");
+    return -1;
+  }
+
+  free(tree->slots);
+  tree->slots = slots;
+  tree->slot_mask = size * 2 - 1;
+  tree->size = size;
+
+  /* the root is in no slot */
+  for(i = 1; i < tree->count; i++)
+    *ftree_slot(tree, nodes[i].parent, nodes[i].name) = i + 1;
+
+  return 0;
+}
+
+static void ftree_init(ftree_t *tree)
+{
+  ftree_node_t *root = &tree->nodes[FTREE_ROOT];
+
+  memset(root, 0, sizeof(ftree_node_t));
+  root->parent = FTREE_NONE;
+  root->child = FTREE_NONE;
+  root->next = FTREE_NONE;
+  root->name = XINTERN_NONE;
+  root->open = 1;
+  tree->count = 1;
+}
+
+ftree_t *ftree_create(void)
+{
+  ftree_t *tree = malloc(sizeof(ftree_t));
+  if(!tree)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(tree, 0, sizeof(ftree_t));
+  tree->names = xintern_create(NULL);
+  if(!tree->names || ftree_grow(tree, FTREE_INIT_SIZE) < 0)
+  {
+    ftree_destroy(tree);
+    return NULL;
+  }
+
+  ftree_init(tree);
+  return tree;
+}
+
+void ftree_destroy(ftree_t *tree)
+{
+  if(!tree)
+    return;
+
+  xintern_destroy(tree->names);
+  free(tree->nodes);
+  free(tree->slots);
+  free(tree->files);
+  free(tree->rows);
+  free(tree);
+}
+
+void ftree_flush(ftree_t *tree)
+{
+  if(!tree)
+    return;
+
+  xintern_flush(tree->names);
+  memset(tree->slots, 0, (tree->slot_mask + 1) * sizeof(unsigned int));
+  if(tree->files)
+    memset(tree->files, 0xff, tree->file_size * sizeof(unsigned int));
+  ftree_init(tree);
+}
+
+/* the child of parent called name, it is added if there is none */
+static unsigned int ftree_child(ftree_t *tree, unsigned int parent,
+                                const char *name, int len)
+{
+  unsigned int name_id = xintern_add(tree->names, name, len);
+  unsigned int *slot = NULL, id = tree->count;
+  ftree_node_t *node = NULL;
+
+  if(name_id == XINTERN_NONE)
+    return FTREE_NONE;
+
+  slot = ftree_slot(tree, parent, name_id);
+  if(*slot)
+    return *slot - 1;
+
+  if(tree->count == tree->size)
+  {
+    if(ftree_grow(tree, tree->size * 2) < 0)
+      return FTREE_NONE;
+    slot = ftree_slot(tree, parent, name_id);
+  }
+
+  node = &tree->nodes[id];
+  memset(node, 0, sizeof(ftree_node_t));
+  node->parent = parent;
+  node->child = FTREE_NONE;
+  node->name = name_id;
+
+  /* new children go first, the listing sorts them again */
+  node->next = tree->nodes[parent].child;
+  tree->nodes[parent].child = id;
+  tree->nodes[parent].sorted = 0;
+
+  *slot = id + 1;
+  tree->count++;
+
+  return id;
+}
+
+/* the node of path, "/a/b" is "", "a", "b" so that a label reads "/a/b" */
+static unsigned int ftree_split(ftree_t *tree, const char *path)
+{
+  unsigned int id = FTREE_ROOT;
+  const char *ptr = path;
+
+  if(*ptr == '/')
+    id = ftree_child(tree, id, "", 0);
+
+  while(*ptr && id != FTREE_NONE)
+  {
+    const char *end = strchr(ptr, '/');
+    int len = end ? end - ptr : strlen(ptr);
+
+    if(len)
+      id = ftree_child(tree, id, ptr, len);
+    ptr += len + (end != NULL);
+  }
+
+  if(id != FTREE_NONE)
+    tree->nodes[id].file = 1;
+
+  return id;
+}
+
+/* the file node of path_id, split path if it is new */
+static unsigned int ftree_file(ftree_t *tree, unsigned int path_id, 
+                               const char *path)
+{
+  if(path_id >= tree->file_size)
+  {
+    unsigned int size = tree->file_size ? tree->file_size : FTREE_INIT_SIZE;
+    unsigned int *files = NULL;
+
+    while(size <= path_id)
+      size *= 2;
+
+    files = realloc(tree->files, size * sizeof(unsigned int));
+    if(!files)
+    {
+      perror("realloc");
+      return FTREE_NONE;
+    }
+
+    memset(files + tree->file_size, 0xff, 
+           (size - tree->file_size) * sizeof(unsigned int));
+    tree->files = files;
+    tree->file_size = size;
+  }
+
+  if(tree->files[path_id] == FTREE_NONE && path)
+    tree->files[path_id] = ftree_split(tree, path);
+
+  return tree->files[path_id];
+}
+
+unsigned int ftree_add(ftree_t *tree, unsigned int path_id, const char *path,
+                       int kind)
+{
+  unsigned int file = ftree_file(tree, path_id, path), id = file;
+
+  if(kind < 0 || kind >= FTREE_KINDS)
+    kind = FTREE_KINDS - 1;
+
+  for(; id != FTREE_NONE; id = tree->nodes[id].parent)
+    tree->nodes[id].count[kind]++;
+
+  return file;
+}
+
+void ftree_remove(ftree_t *tree, unsigned int path_id, int kind)
+{
+  unsigned int id = FTREE_NONE;
+
+  if(path_id < tree->file_size)
+    id = tree->files[path_id];
+
+  if(kind < 0 || kind >= FTREE_KINDS)
+    kind = FTREE_KINDS - 1;
+
+  for(; id != FTREE_NONE; id = tree->nodes[id].parent)
+  {
+    if(tree->nodes[id].count[kind])
+      tree->nodes[id].count[kind]--;
+  }
+}
+
+unsigned int ftree_total(ftree_t *tree, unsigned int id)
+{
+  ftree_node_t *node = ftree_node(tree, id);
+  unsigned int total = 0;
+  int i = 0;
+
+  for(; node && i < FTREE_KINDS; i++)
+    total += node->count[i];
+
+  return total;
+}
+
+typedef struct
+{
+  const char *name;
+  unsigned int id;
+}ftree_sibling_t;
+
+static int ftree_sibling_cmp(const void *p1, const void *p2)
+{
+  return strcmp(((const ftree_sibling_t *)p1)->name, 
+                ((const ftree_sibling_t *)p2)->name);
+}
+
+/* link the children of id by name, only after a new one came */
+static void ftree_sort(ftree_t *tree, unsigned int id)
+{
+  ftree_sibling_t *siblings = NULL;
+  unsigned int child = tree->nodes[id].child, count = 0, i = 0;
+
+  for(; child != FTREE_NONE; child = tree->nodes[child].next)
+    count++;
+
+  siblings = malloc((count ? count : 1) * sizeof(ftree_sibling_t));
+  if(!siblings)
+  {
+    perror("malloc");
+    return;
+  }
+
+  for(child = tree->nodes[id].child; child != FTREE_NONE; 
+      child = tree->nodes[child].next)
+  {
+    siblings[i].name = xintern_str(tree->names, tree->nodes[child].name);
+    siblings[i++].id = child;
+  }
+
+  qsort(siblings, count, sizeof(ftree_sibling_t), ftree_sibling_cmp);
+
+  tree->nodes[id].child = FTREE_NONE;
+  while(i--)
+  {
+    tree->nodes[siblings[i].id].next = tree->nodes[id].child;
+    tree->nodes[id].child = siblings[i].id;
+  }
+
+  tree->nodes[id].sorted = 1;
+  free(siblings);
+}
+
+/* a directory whose only child is a directory */
+static int ftree_lone(ftree_t *tree, unsigned int id)
+{
+  ftree_node_t *node = &tree->nodes[id];
+
+  return !node->file && node->child != FTREE_NONE
+         && tree->nodes[node->child].next == FTREE_NONE
+         && tree->nodes[node->child].child != FTREE_NONE;
+}
+
+static int ftree_list_push(ftree_t *tree, unsigned int count, 
+                           const ftree_row_t *row)
+{
+  if(count == tree->row_size)
+  {
+    unsigned int size = tree->row_size ? tree->row_size * 2 : FTREE_INIT_SIZE;
+    ftree_row_t *rows = realloc(tree->rows, size * sizeof(ftree_row_t));
+    if(!rows)
+    {
+      perror("realloc");
+      return -1;
+    }
+
+    tree->rows = rows;
+    tree->row_size = size;
+  }
+
+  tree->rows[count] = *row;
+  return 0;
+}
+
+/* list the children of id from rows[count], return the new count */
+static unsigned int ftree_list_node(ftree_t *tree, unsigned int id, 
+                                    unsigned int depth, unsigned int count)
+{
+  unsigned int child = FTREE_NONE;
+
+  if(!tree->nodes[id].sorted)
+    ftree_sort(tree, id);
+
+  for(child = tree->nodes[id].child; child != FTREE_NONE; 
+      child = tree->nodes[child].next)
+  {
+    ftree_row_t row = {child, child, depth};
+
+    /* files whose rows are all evicted are left out */
+    if(!ftree_total(tree, child))
+      continue;
+
+    while(ftree_lone(tree, row.node))
+      row.node = tree->nodes[row.node].child;
+
+    if(ftree_list_push(tree, count, &row) < 0)
+      break;
+    count++;
+
+    if(tree->nodes[row.node].open && depth < FTREE_MAX_DEPTH)
+      count = ftree_list_node(tree, row.node, depth + 1, count);
+  }
+
+  return count;
+}
+
+unsigned int ftree_list(ftree_t *tree, ftree_row_t **rows)
+{
+  unsigned int count = ftree_list_node(tree, FTREE_ROOT, 0, 0);
+
+  *rows = tree->rows;
+  return count;
+}
+
+/* join the names from first down to last with '/' */
+static int ftree_join(ftree_t *tree, unsigned int first, unsigned int last,
+                      char *buf, int size)
+{
+  unsigned int ids[FTREE_MAX_DEPTH];
+  int depth = 0, len = 0;
+
+  for(; depth < FTREE_MAX_DEPTH; last = tree->nodes[last].parent)
+  {
+    ids[depth++] = last;
+    if(last == first)
+      break;
+  }
+
+  buf[0] = '\0';
+  while(depth-- && len < size)
+  {
+    len += snprintf(buf + len, size - len, "%s%s", 
+                    xintern_str(tree->names, tree->nodes[ids[depth]].name),
+                    depth ? "/" : "");
+  }
+
+  return len < size ? len : size - 1;
+}
+
+int ftree_label(ftree_t *tree, const ftree_row_t *row, char *buf, int size)
+{
+  int len = ftree_join(tree, row->first, row->node, buf, size);
+
+  /* a trailing '/' tells a directory */
+  if(tree->nodes[row->node].child != FTREE_NONE && len < size - 1)
+  {
+    buf[len++] = '/';
+    buf[len] = '\0';
+  }
+
+  return len;
+}
+
+int ftree_path(ftree_t *tree, unsigned int id, char *buf, int size)
+{
+  unsigned int first = id;
+
+  if(!ftree_node(tree, id) || id == FTREE_ROOT)
+  {
+    buf[0] = '\0';
+    return 0;
+  }
+
+  while(tree->nodes[first].parent != FTREE_ROOT)
+    first = tree->nodes[first].parent;
+
+  return ftree_join(tree, first, id, buf, size);
+}
+
+size_t ftree_bytes(ftree_t *tree)
+{
+  size_t bytes = sizeof(ftree_t);
+
+  bytes += tree->size * (sizeof(ftree_node_t) + 2 * sizeof(unsigned int));
+  bytes += tree->file_size * sizeof(unsigned int);
+  bytes += tree->row_size * sizeof(ftree_row_t);
+  bytes += xintern_bytes(tree->names);
+
+  return bytes;
+}
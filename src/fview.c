@@ -0,0 +1,215 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fview.h"
+
+void fview_init(fview_t *view, fstore_t *store)
+{
+  memset(view, 0, sizeof(fview_t));
+  view->store = store;
+  view->sort = FSORT_DEFAULT;
+  view->page = 1;
+}
+
+static void fview_tail(fview_t *view);
+
+void fview_clamp(fview_t *view)
+{
+  unsigned long long total = fview_count(view);
+
+  if(view->follow)
+  {
+    fview_tail(view);
+    return;
+  }
+
+  if(!total)
+    view->top = 0;
+  else if(view->top >= total)
+    view->top = total - 1;
+}
+
+void fview_sort(fview_t *view, fsort_t sort)
+{
+  unsigned int id = fview_top_id(view);
+  long rank = -1;
+
+  view->sort = sort;
+  if(view->subset)
+    fstore_subset_sort(view->store, view->subset, sort);
+
+  if(id != FSTORE_NONE)
+    rank = xskiplist_rank(fview_index(view), id);
+
+  view->top = rank < 0 ? 0 : rank;
+  fview_clamp(view);
+}
+
+unsigned int fview_top_id(fview_t *view)
+{
+  xsknode_t *node = xskiplist_at(fview_index(view), view->top);
+
+  return node ? node->id : FSTORE_NONE;
+}
+
+void fview_set_subset(fview_t *view, xskiplist_t *subset, unsigned int id)
+{
+  long rank = -1;
+
+  view->subset = subset;
+  if(id != FSTORE_NONE)
+    rank = xskiplist_rank(fview_index(view), id);
+
+  view->top = rank < 0 ? 0 : rank;
+  fview_clamp(view);
+}
+
+void fview_set_page(fview_t *view, unsigned int page)
+{
+  view->page = page ? page : 1;
+}
+
+void fview_scroll(fview_t *view, long long rows)
+{
+  if(!rows)
+    return;
+
+  view->follow = 0;
+  if(rows < 0 && view->top < -rows)
+    view->top = 0;
+  else
+    view->top += rows;
+
+  fview_clamp(view);
+}
+
+/* the first row starting at line or after it */
+static unsigned long long fview_row_from(fview_t *view, unsigned long long line)
+{
+  long rank = fstore_row_at_line(view->store, fview_index(view), line);
+
+  if(rank < 0)
+    return fview_count(view);
+
+  if(fstore_lines_above(view->store, fview_index(view), rank) < line)
+    rank++;
+
+  return rank;
+}
+
+void fview_page(fview_t *view, int pages)
+{
+  xskiplist_t *index = fview_index(view);
+  unsigned long long line = fstore_lines_above(view->store, index, view->top);
+  unsigned long long step = (unsigned long long)view->page * 
+                            (pages < 0 ? -pages : pages);
+  unsigned long long top = view->top;
+
+  if(!pages)
+    return;
+
+  view->follow = 0;
+  if(pages > 0)
+  {
+    long rank = fstore_row_at_line(view->store, index, line + step);
+
+    /* a row taller than the screen is still left behind */
+    top = rank < 0 ? fview_count(view) : rank;
+    if(top <= view->top)
+      top = view->top + 1;
+  }
+  else if(pages < 0)
+  {
+    /* the old top row comes right below the new screen */
+    top = fview_row_from(view, line > step ? line - step : 0);
+    if(top >= view->top && view->top)
+      top = view->top - 1;
+  }
+
+  view->top = top;
+  fview_clamp(view);
+}
+
+void fview_home(fview_t *view)
+{
+  view->follow = 0;
+  view->top = 0;
+}
+
+/* the last page is full, not a single row */
+static void fview_tail(fview_t *view)
+{
+  unsigned long long lines = fstore_lines(view->store, fview_index(view));
+  unsigned long long total = fview_count(view);
+
+  view->top = 0;
+  if(lines > view->page)
+    view->top = fview_row_from(view, lines - view->page);
+  if(total && view->top >= total)
+    view->top = total - 1;
+}
+
+void fview_end(fview_t *view)
+{
+  view->follow = 1;
+  fview_tail(view);
+}
+
+void fview_percent(fview_t *view, int percent)
+{
+  unsigned long long total = fview_count(view);
+
+  if(percent < 0)
+    percent = 0;
+  if(percent > 100)
+    percent = 100;
+
+  view->follow = 0;
+  view->top = total * percent / 100;
+  fview_clamp(view);
+}
+
+int fview_next_error(fview_t *view)
+{
+  long rank = fstore_next_error(view->store, fview_index(view), view->top);
+
+  if(rank < 0)
+    return -1;
+
+  view->follow = 0;
+  view->top = rank;
+  return 0;
+}
+
+int fview_next_file(fview_t *view)
+{
+  long rank = fstore_next_file(view->store, fview_index(view), view->top);
+
+  if(rank < 0)
+    return -1;
+
+  view->follow = 0;
+  view->top = rank;
+  return 0;
+}
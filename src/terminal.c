@@ -20,9 +20,15 @@
  */
  
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <termios.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <ctype.h>
+#include <string.h>
+#include <sys/ioctl.h>
 #include "xdebug.h"
 #include "terminal.h"
 
@@ -36,9 +42,18 @@ static void terminal_curosr_hide(int yes)
 
 /* for terminal ctl */
 static struct termios initial_settings;
+/* report mouse buttons in the SGR form, only the wheel is used */
+#define MOUSE_ON  "\033[?1000h\033[?1006h"
+#define MOUSE_OFF "\033[?1006l\033[?1000l"
+/* draw on the alternate screen, the shell gets its own screen back */
+#define ALT_SCREEN_ON  "\033[?1049h"
+#define ALT_SCREEN_OFF "\033[r\033[?1049l"
+
 void terminal_reset(void)
 {
   tcsetattr(STDIN_FILENO, TCSANOW, &initial_settings);
+  printf(MOUSE_OFF);
+  printf(ALT_SCREEN_OFF);
   terminal_curosr_hide(0);
 }
 
@@ -97,6 +112,277 @@ static void install_signals(int sigs, void (*f)(int))
   }
 }
 
+/* It is perfectly ok to pass in a NULL for either width or for
+ * height, in which case that value will not be set.  */
+int get_terminal_width_height(int fd, int *width, int *height)
+{
+  struct winsize win = { 0, 0, 0, 0 };
+  int ret = ioctl(fd, TIOCGWINSZ, &win);
+  
+  if (height)
+  {
+    if (!win.ws_row) 
+    {
+      char *s = getenv("LINES");
+      if (s) win.ws_row = atoi(s);
+    }
+    if (win.ws_row <= 1 || win.ws_row >= 30000)
+      win.ws_row = 24;
+    *height = (int) win.ws_row;
+  }
+  
+  if (width) 
+  {
+    if (!win.ws_col) 
+    {
+      char *s = getenv("COLUMNS");
+      if (s) win.ws_col = atoi(s);
+    }
+    if (win.ws_col <= 1 || win.ws_col >= 30000)
+            win.ws_col = 80;
+    *width = (int) win.ws_col;
+  }
+  
+  return ret;
+}
+
+int terminal_backlog(int fd)
+{
+  int queued = 0;
+
+  if(ioctl(fd, TIOCOUTQ, &queued) < 0)
+    return -1;
+
+  return queued;
+}
+
+/* geometry cache, refreshed by SIGWINCH through a self pipe */
+static int winch_pipe[2] = {-1, -1};
+static int term_width = 80;
+static int term_height = 24;
+
+static void sig_winch(int sig)
+{
+  int saved = errno;
+  char c = 0;
+  ssize_t ret = 0;
+
+  /* the pipe is non-blocking, a full one already has an event queued */
+  ret = write(winch_pipe[1], &c, 1);
+  (void)ret;
+  errno = saved;
+}
+
+void terminal_geometry(int *width, int *height)
+{
+  if(width)
+    *width = term_width;
+  if(height)
+    *height = term_height;
+}
+
+int terminal_winch_fd()
+{
+  return winch_pipe[0];
+}
+
+int terminal_winch()
+{
+  char buf[64];
+  int width = 0, height = 0;
+
+  while(winch_pipe[0] >= 0 && read(winch_pipe[0], buf, sizeof(buf)) > 0)
+    ;
+
+  get_terminal_width_height(STDOUT_FILENO, &width, &height);
+  if(width == term_width && height == term_height)
+    return 0;
+
+  term_width = width;
+  term_height = height;
+  return 1;
+}
+
+static void terminal_winch_init()
+{
+  int i = 0;
+
+  if(pipe(winch_pipe) < 0)
+  {
+    perror("pipe");
+    winch_pipe[0] = winch_pipe[1] = -1;
+    return;
+  }
+
+  for(i = 0; i < 2; i++)
+  {
+    fcntl(winch_pipe[i], F_SETFL, fcntl(winch_pipe[i], F_GETFL) | O_NONBLOCK);
+    fcntl(winch_pipe[i], F_SETFD, FD_CLOEXEC);
+  }
+
+  signal(SIGWINCH, sig_winch);
+}
+
+/* bytes read but not parsed yet, an incomplete sequence */
+static unsigned char key_buf[TERMINAL_KEY_BUF];
+static int key_len = 0;
+
+/* 
+ * parse one key at buf, return the bytes it takes, 0 if it is incomplete
+ * or minus the bytes of a sequence we don't know, which is skipped. a
+ * lone ESC is incomplete too, a sequence may follow it
+ */
+static int terminal_parse_key(const unsigned char *buf, int len, 
+                              terminal_key_t *key)
+{
+  int i = 2, param = 0, button = -1;
+
+  key->code = TERMINAL_KEY_CHAR;
+  key->c = buf[0];
+  if(buf[0] != '\033')
+    return 1;
+  if(len == 1)
+    return 0;
+
+  /* SS3: \033O + final */
+  if(buf[1] == 'O')
+  {
+    if(len < 3)
+      return 0;
+
+    switch(buf[2])
+    {
+      case 'A': key->code = TERMINAL_KEY_UP; break;
+      case 'B': key->code = TERMINAL_KEY_DOWN; break;
+      case 'C': key->code = TERMINAL_KEY_RIGHT; break;
+      case 'D': key->code = TERMINAL_KEY_LEFT; break;
+      case 'H': key->code = TERMINAL_KEY_HOME; break;
+      case 'F': key->code = TERMINAL_KEY_END; break;
+      default: return -3;
+    }
+    return 3;
+  }
+
+  /* a lone ESC, or ESC + a key */
+  if(buf[1] != '[')
+    return 1;
+
+  /* CSI: \033[ + parameters + a final byte in 0x40-0x7e */
+  if(len > 2 && buf[2] == '<')
+    i++;
+
+  for(; i < len && buf[i] >= 0x20 && buf[i] < 0x40; i++)
+  {
+    if(isdigit(buf[i]))
+      param = param * 10 + buf[i] - '0';
+    else if(buf[i] == ';' && button < 0)
+    {
+      button = param; /* the first parameter, the SGR mouse button */
+      param = 0;
+    }
+  }
+
+  if(i == len)
+    return 0;
+
+  if(button < 0)
+    button = param;
+
+  switch(buf[i])
+  {
+    case 'A': key->code = TERMINAL_KEY_UP; break;
+    case 'B': key->code = TERMINAL_KEY_DOWN; break;
+    case 'C': key->code = TERMINAL_KEY_RIGHT; break;
+    case 'D': key->code = TERMINAL_KEY_LEFT; break;
+    case 'H': key->code = TERMINAL_KEY_HOME; break;
+    case 'F': key->code = TERMINAL_KEY_END; break;
+    case '~':
+      switch(button)
+      {
+        case 1: case 7: key->code = TERMINAL_KEY_HOME; break;
+        case 4: case 8: key->code = TERMINAL_KEY_END; break;
+        case 5: key->code = TERMINAL_KEY_PGUP; break;
+        case 6: key->code = TERMINAL_KEY_PGDN; break;
+        default: return -(i + 1);
+      }
+      break;
+    case 'M':
+    case 'm':
+      /* SGR mouse, 64/65 are the wheel, shift/meta/ctrl bits dropped */
+      if(buf[2] == '<' && buf[i] == 'M' && (button & ~0x1c) == 64)
+        key->code = TERMINAL_KEY_WHEEL_UP;
+      else if(buf[2] == '<' && buf[i] == 'M' && (button & ~0x1c) == 65)
+        key->code = TERMINAL_KEY_WHEEL_DOWN;
+      else
+        return -(i + 1);
+      break;
+    default:
+      return -(i + 1);
+  }
+
+  return i + 1;
+}
+
+/* 
+ * parse the buffered bytes into keys. an incomplete sequence stays for
+ * more bytes unless flush is set, its bytes are then keys by themselves
+ */
+static int terminal_parse_keys(terminal_key_t *keys, int max, int flush)
+{
+  int count = 0, pos = 0;
+
+  while(pos < key_len && count < max)
+  {
+    int ret = terminal_parse_key(key_buf + pos, key_len - pos, &keys[count]);
+
+    /* a sequence cut by the read, unless nothing more can come */
+    if(!ret)
+    {
+      if(!flush && key_len - pos < 32)
+        break;
+      ret = 1;
+    }
+
+    if(ret > 0)
+      count++;
+    pos += ret > 0 ? ret : -ret;
+  }
+
+  memmove(key_buf, key_buf + pos, key_len - pos);
+  key_len -= pos;
+
+  return count;
+}
+
+int terminal_read_keys(int fd, terminal_key_t *keys, int max)
+{
+  ssize_t n = 0;
+
+  if(key_len == sizeof(key_buf))
+    key_len = 0;
+
+  do
+  {
+    n = read(fd, key_buf + key_len, sizeof(key_buf) - key_len);
+  }while(n < 0 && errno == EINTR);
+
+  if(n <= 0)
+    return n;
+  key_len += n;
+
+  return terminal_parse_keys(keys, max, 0);
+}
+
+int terminal_keys_pending()
+{
+  return key_len > 0;
+}
+
+int terminal_flush_keys(terminal_key_t *keys, int max)
+{
+  return terminal_parse_keys(keys, max, 1);
+}
+
 /* Ctrl+C code */
 char terminal_ctrlc()
 {
@@ -115,6 +401,12 @@ void terminal_init()
 
   install_signals(FATAL_SIGS, sig_catcher);
   tcsetattr(STDIN_FILENO, TCSANOW, &new_settings);
+
+  terminal_winch_init();
+  terminal_winch();
+
+  printf(ALT_SCREEN_ON);
+  printf(MOUSE_ON);
   
   
   terminal_curosr_hide(1);
@@ -0,0 +1,110 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xarena.h"
+
+void xarena_init(xarena_t *arena)
+{
+  memset(arena, 0, sizeof(xarena_t));
+}
+
+void xarena_flush(xarena_t *arena)
+{
+  xarena_chunk_t *chunk = arena->head, *next = NULL;
+
+  for(; chunk; chunk = next)
+  {
+    next = chunk->next;
+    free(chunk);
+  }
+
+  xarena_init(arena);
+}
+
+void *xarena_alloc(xarena_t *arena, size_t size)
+{
+  xarena_chunk_t *chunk = arena->head;
+  void *ptr = NULL;
+
+  if(!chunk || chunk->size - chunk->used < size)
+  {
+    size_t chunk_size = XARENA_CHUNK_SIZE;
+
+    /* a huge one gets a chunk of its own */
+    if(size > chunk_size / 4)
+      chunk_size = size;
+
+    chunk = malloc(sizeof(xarena_chunk_t) + chunk_size);
+    if(!chunk)
+    {
+      perror("malloc");
+      return NULL;
+    }
+
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    arena->bytes += sizeof(xarena_chunk_t) + chunk_size;
+
+    /* keep filling the current chunk if the new one is a private one */
+    if(arena->head && chunk_size == size)
+    {
+      chunk->next = arena->head->next;
+      arena->head->next = chunk;
+    }
+    else
+    {
+      chunk->next = arena->head;
+      arena->head = chunk;
+    }
+  }
+
+  ptr = chunk->data + chunk->used;
+  chunk->used += size;
+  arena->used += size;
+
+  return ptr;
+}
+
+char *xarena_strndup(xarena_t *arena, const char *str, size_t len)
+{
+  char *dst = xarena_alloc(arena, len + 1);
+  if(!dst)
+    return NULL;
+
+  memcpy(dst, str, len);
+  dst[len] = '\0';
+
+  return dst;
+}
+
+size_t xarena_bytes(xarena_t *arena)
+{
+  return arena->bytes;
+}
+
+size_t xarena_used(xarena_t *arena)
+{
+  return arena->used;
+}
@@ -0,0 +1,167 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xbitset.h"
+
+#define XBITSET_INIT_WORDS 16
+
+void xbitset_init(xbitset_t *set)
+{
+  memset(set, 0, sizeof(xbitset_t));
+}
+
+void xbitset_release(xbitset_t *set)
+{
+  free(set->words);
+  xbitset_init(set);
+}
+
+/* grow to size words at least, the new words are 0 */
+static int xbitset_grow(xbitset_t *set, unsigned int size)
+{
+  unsigned int new_size = set->size ? set->size : XBITSET_INIT_WORDS;
+  unsigned long long *words = NULL;
+
+  if(size <= set->size)
+    return 0;
+
+  while(new_size < size)
+    new_size *= 2;
+
+  words = realloc(set->words, new_size * sizeof(unsigned long long));
+  if(!words)
+  {
+    perror("realloc");
+    return -1;
+  }
+
+  memset(words + set->size, 0, 
+         (new_size - set->size) * sizeof(unsigned long long));
+  set->words = words;
+  set->size = new_size;
+
+  return 0;
+}
+
+int xbitset_set(xbitset_t *set, unsigned int bit)
+{
+  if(xbitset_grow(set, bit / 64 + 1) < 0)
+    return -1;
+
+  set->words[bit / 64] |= 1ULL << (bit % 64);
+  return 0;
+}
+
+void xbitset_clear(xbitset_t *set, unsigned int bit)
+{
+  if(bit / 64 < set->size)
+    set->words[bit / 64] &= ~(1ULL << (bit % 64));
+}
+
+void xbitset_zero(xbitset_t *set)
+{
+  if(set->size)
+    memset(set->words, 0, set->size * sizeof(unsigned long long));
+}
+
+int xbitset_copy(xbitset_t *dst, const xbitset_t *src)
+{
+  if(xbitset_grow(dst, src->size) < 0)
+    return -1;
+
+  if(src->size)
+    memcpy(dst->words, src->words, src->size * sizeof(unsigned long long));
+  if(dst->size > src->size)
+    memset(dst->words + src->size, 0, 
+           (dst->size - src->size) * sizeof(unsigned long long));
+
+  return 0;
+}
+
+int xbitset_or(xbitset_t *dst, const xbitset_t *src)
+{
+  unsigned int i = 0;
+
+  if(xbitset_grow(dst, src->size) < 0)
+    return -1;
+
+  for(; i < src->size; i++)
+    dst->words[i] |= src->words[i];
+
+  return 0;
+}
+
+void xbitset_and(xbitset_t *dst, const xbitset_t *src)
+{
+  unsigned int i = 0;
+
+  for(; i < dst->size; i++)
+    dst->words[i] &= i < src->size ? src->words[i] : 0;
+}
+
+void xbitset_andnot(xbitset_t *dst, const xbitset_t *src)
+{
+  unsigned int i = 0;
+  unsigned int size = dst->size < src->size ? dst->size : src->size;
+
+  for(; i < size; i++)
+    dst->words[i] &= ~src->words[i];
+}
+
+unsigned long xbitset_count(const xbitset_t *set)
+{
+  unsigned long count = 0;
+  unsigned int i = 0;
+
+  for(; i < set->size; i++)
+    count += __builtin_popcountll(set->words[i]);
+
+  return count;
+}
+
+long xbitset_next(const xbitset_t *set, unsigned int from)
+{
+  unsigned int i = from / 64;
+  unsigned long long word = 0;
+
+  if(i >= set->size)
+    return -1;
+
+  /* the bits below from in the first word are masked out */
+  word = set->words[i] & (~0ULL << (from % 64));
+  while(!word)
+  {
+    if(++i >= set->size)
+      return -1;
+    word = set->words[i];
+  }
+
+  return (long)i * 64 + __builtin_ctzll(word);
+}
+
+size_t xbitset_bytes(const xbitset_t *set)
+{
+  return set->size * sizeof(unsigned long long);
+}
@@ -652,6 +652,60 @@ bad:
   xdie("bad color value for variable '%s'\n", value);
 }
 
+#define XCOLOR_DEFINE(name, spec, code) \
+  const xcolor_t name = { spec, code, sizeof(code) - 1 }
+
+XCOLOR_DEFINE(xcolor_normal, "normal", COLOR_NORMAL);
+XCOLOR_DEFINE(xcolor_red_bold, "red bold", COLOR_BOLD_RED);
+XCOLOR_DEFINE(xcolor_green_bold, "green bold", COLOR_BOLD_GREEN);
+XCOLOR_DEFINE(xcolor_yellow_bold, "yellow bold", COLOR_BOLD_YELLOW);
+
+typedef struct xcolor_cache
+{
+  xcolor_t color;
+  struct xcolor_cache *next;
+}xcolor_cache_t;
+
+/* specs compiled at run time, kept for the life of the process */
+static xcolor_cache_t *color_cache;
+
+const xcolor_t *color_compile(const char *spec)
+{
+  static const xcolor_t *builtins[] =
+  {
+    &xcolor_normal, &xcolor_red_bold, &xcolor_green_bold, &xcolor_yellow_bold,
+  };
+
+  xcolor_cache_t *entry = NULL;
+  int i = 0;
+
+  if(!spec)
+    return &xcolor_normal;
+
+  for(i = 0; i < ARRAY_SIZE(builtins); i++)
+    if(!strcmp(builtins[i]->spec, spec))
+      return builtins[i];
+
+  for(entry = color_cache; entry; entry = entry->next)
+    if(!strcmp(entry->color.spec, spec))
+      return &entry->color;
+
+  entry = malloc(sizeof(xcolor_cache_t) + strlen(spec) + 1);
+  if(!entry)
+  {
+    perror("malloc");
+    return &xcolor_normal;
+  }
+
+  color_parse(entry->color.code, spec);
+  entry->color.len = strlen(entry->color.code);
+  entry->color.spec = strcpy((char *)(entry + 1), spec);
+  entry->next = color_cache;
+  color_cache = entry;
+
+  return &entry->color;
+}
+
 static int color_vfprintf(FILE *fp, const char *color_code, const char *fmt,
                           va_list args, const char *trail)
 {
@@ -670,18 +724,56 @@ static int color_vfprintf(FILE *fp, const char *color_code, const char *fmt,
   return r;
 }
 
+int xcolor_vsnprintf(char *buf, size_t size, const xcolor_t *color,
+                     const char *fmt, va_list args)
+{
+  int colored = color && color->len;
+  int reset = sizeof(COLOR_RESET) - 1;
+  int r = 0, len = 0;
+
+  /* keep counting when buf is full, the caller may retry with more */
+  if (colored)
+  {
+    if(color->len < size)
+      memcpy(buf, color->code, color->len);
+    r += color->len;
+  }
+
+  len = vsnprintf(buf + (r < size ? r : 0), r < size ? size - r : 0, 
+                  fmt, args);
+  if(len < 0)
+    return len;
+  r += len;
+
+  if (colored)
+  {
+    if(r + reset < size)
+      memcpy(buf + r, COLOR_RESET, reset + 1);
+    r += reset;
+  }
+
+  return r;
+}
+
 void color_fprintf(FILE *fp, const char *color, const char *fmt, ...)
 {
-  char color_code[16] = "";
   va_list args;
 
   va_start(args, fmt);
-  color_parse(color_code, color);
-  color_vfprintf(fp, color_code, fmt, args, NULL);
+  color_vfprintf(fp, color_compile(color)->code, fmt, args, NULL);
   va_end(args);
   
   fflush(fp);
 }
 
+void xcolor_fprintf(FILE *fp, const xcolor_t *color, const char *fmt, ...)
+{
+  va_list args;
+
+  va_start(args, fmt);
+  color_vfprintf(fp, color ? color->code : "", fmt, args, NULL);
+  va_end(args);
+}
+
 #endif /* XDEBUG */
 
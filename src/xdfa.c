@@ -0,0 +1,486 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xdfa.h"
+#include "xhset.h"
+
+/* tokens over 255 are not bytes */
+#define XDFA_TOK_ANY  256
+#define XDFA_TOK_STAR 257
+#define XDFA_TOK_END  258
+
+#define XDFA_BIT(set, p) ((set)[(p) / 64] >> ((p) % 64) & 1)
+
+xdfa_t *xdfa_create(unsigned char sep)
+{
+  xdfa_t *dfa = malloc(sizeof(xdfa_t));
+  if(!dfa)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(dfa, 0, sizeof(xdfa_t));
+  dfa->sep = sep;
+  return dfa;
+}
+
+/* the masks and the states, the globs stay */
+static void xdfa_release(xdfa_t *dfa)
+{
+  free(dfa->adv);
+  free(dfa->stay);
+  free(dfa->star);
+  free(dfa->ends);
+  free(dfa->twin);
+  free(dfa->sets);
+  free(dfa->next);
+  free(dfa->accept);
+  free(dfa->table);
+  free(dfa->scratch);
+
+  dfa->adv = dfa->stay = dfa->star = dfa->ends = NULL;
+  dfa->sets = dfa->accept = dfa->scratch = NULL;
+  dfa->twin = dfa->next = dfa->table = NULL;
+  dfa->states = dfa->mask = 0;
+}
+
+void xdfa_destroy(xdfa_t *dfa)
+{
+  if(!dfa)
+    return;
+
+  xdfa_release(dfa);
+  free(dfa->tokens);
+  free(dfa->owner);
+  free(dfa);
+}
+
+static int xdfa_push(xdfa_t *dfa, short token, int bit)
+{
+  if(dfa->count == dfa->size)
+  {
+    unsigned int size = dfa->size ? dfa->size * 2 : 256;
+    short *tokens = realloc(dfa->tokens, size * sizeof(short));
+    unsigned char *owner = NULL;
+
+    if(tokens)
+      dfa->tokens = tokens;
+    owner = realloc(dfa->owner, size);
+    if(owner)
+      dfa->owner = owner;
+    if(!tokens || !owner)
+    {
+      perror("realloc");
+      return -1;
+    }
+
+    dfa->size = size;
+  }
+
+  dfa->tokens[dfa->count] = token;
+  dfa->owner[dfa->count++] = bit;
+  return 0;
+}
+
+int xdfa_add(xdfa_t *dfa, const char *glob, size_t len, int bit)
+{
+  size_t i = 0;
+
+  if(bit < 0 || bit >= XDFA_MAX_GLOBS 
+     || (dfa->count && bit < dfa->owner[dfa->count - 1]))
+    return -1;
+
+  for(; i < len; i++)
+  {
+    short token = (unsigned char)glob[i];
+
+    /* "**" is "*", there are never two '*' in a row */
+    if(glob[i] == '*')
+    {
+      if(i && glob[i - 1] == '*' 
+         && dfa->tokens[dfa->count - 1] == XDFA_TOK_STAR)
+        continue;
+      token = XDFA_TOK_STAR;
+    }
+    else if(glob[i] == '?')
+      token = XDFA_TOK_ANY;
+    else if(glob[i] == '\\' && i + 1 < len)
+      token = (unsigned char)glob[++i];
+
+    if(xdfa_push(dfa, token, bit) < 0)
+      return -1;
+  }
+
+  return xdfa_push(dfa, XDFA_TOK_END, bit);
+}
+
+/* the bytes no glob names are one class, the separator is one of its own */
+static void xdfa_classes(xdfa_t *dfa)
+{
+  unsigned int i = 0;
+
+  memset(dfa->classes, 0, sizeof(dfa->classes));
+  dfa->class_count = 1;
+  dfa->classes[dfa->sep] = dfa->class_count++;
+
+  for(; i < dfa->count; i++)
+  {
+    short token = dfa->tokens[i];
+
+    if(token < 256 && !dfa->classes[token])
+      dfa->classes[token] = dfa->class_count++;
+  }
+}
+
+/* the tokens left from p and from q are the same, up to their ends */
+static int xdfa_same_rest(xdfa_t *dfa, unsigned int p, unsigned int q)
+{
+  for(; dfa->tokens[p] == dfa->tokens[q]; p++, q++)
+  {
+    if(dfa->tokens[p] == XDFA_TOK_END)
+      return 1;
+  }
+
+  return 0;
+}
+
+/* link every position to the one before it with the same tokens left */
+static int xdfa_twins(xdfa_t *dfa)
+{
+  unsigned long long *hash = malloc(dfa->count * sizeof(unsigned long long));
+  unsigned int p = dfa->count, q = 0;
+
+  if(!hash)
+  {
+    perror("malloc");
+    return -1;
+  }
+
+  while(p--)
+  {
+    short token = dfa->tokens[p];
+    unsigned long long h = token == XDFA_TOK_END ? XHSET_SEED : hash[p + 1];
+
+    hash[p] = xhset_hash(h, &token, sizeof(token));
+  }
+
+  for(p = 0; p < dfa->count; p++)
+  {
+    dfa->twin[p] = XDFA_UNKNOWN;
+    for(q = p; q-- > 0;)
+    {
+      if(hash[q] == hash[p] && xdfa_same_rest(dfa, q, p))
+      {
+        dfa->twin[p] = q;
+        break;
+      }
+    }
+  }
+
+  free(hash);
+  return 0;
+}
+
+/* set the bits of the masks for the position of each token */
+static void xdfa_masks(xdfa_t *dfa)
+{
+  unsigned int words = dfa->words, p = 0;
+  int sep = dfa->classes[dfa->sep], c = 0;
+
+  for(; p < dfa->count; p++)
+  {
+    short token = dfa->tokens[p];
+    unsigned long long bit = 1ULL << (p % 64);
+
+    if(token < 256)
+      dfa->adv[dfa->classes[token] * words + p / 64] |= bit;
+    else if(token == XDFA_TOK_END)
+      dfa->ends[p / 64] |= bit;
+    else if(token == XDFA_TOK_STAR)
+      dfa->star[p / 64] |= bit;
+
+    /* the wildcards take any byte but the separator */
+    for(c = 0; token >= 256 && token != XDFA_TOK_END && c < dfa->class_count; 
+        c++)
+    {
+      if(c == sep)
+        continue;
+      if(token == XDFA_TOK_ANY)
+        dfa->adv[c * words + p / 64] |= bit;
+      else
+        dfa->stay[c * words + p / 64] |= bit;
+    }
+  }
+}
+
+/* 
+ * '*' may match nothing: the position after one is live too. then drop
+ * what an earlier glob matches as well
+ */
+static void xdfa_close(xdfa_t *dfa, unsigned long long *set)
+{
+  unsigned long long carry = 0;
+  unsigned int w = 0;
+
+  for(; w < dfa->words; w++)
+  {
+    unsigned long long star = set[w] & dfa->star[w];
+
+    set[w] |= star << 1 | carry;
+    carry = star >> 63;
+  }
+
+  for(w = 0; w < dfa->words; w++)
+  {
+    unsigned long long word = set[w];
+
+    while(word)
+    {
+      unsigned int p = w * 64 + __builtin_ctzll(word);
+      unsigned int q = dfa->twin[p];
+
+      word &= word - 1;
+      for(; q != XDFA_UNKNOWN; q = dfa->twin[q])
+      {
+        if(XDFA_BIT(set, q))
+        {
+          set[w] &= ~(1ULL << (p % 64));
+          break;
+        }
+      }
+    }
+  }
+}
+
+static unsigned long long xdfa_hash(xdfa_t *dfa, const unsigned long long *set)
+{
+  return xhset_hash(XHSET_SEED, set, dfa->words * sizeof(unsigned long long));
+}
+
+/* room for states, a power of 2. the hash table stays at most half full */
+static int xdfa_grow(xdfa_t *dfa, unsigned int states)
+{
+  unsigned long long *sets = NULL, *accept = NULL;
+  unsigned int *next = NULL, *table = NULL;
+  unsigned int mask = 0, i = 0;
+
+  sets = realloc(dfa->sets, 
+                 (size_t)states * dfa->words * sizeof(unsigned long long));
+  if(sets)
+    dfa->sets = sets;
+  next = realloc(dfa->next, 
+                 (size_t)states * dfa->class_count * sizeof(unsigned int));
+  if(next)
+    dfa->next = next;
+  accept = realloc(dfa->accept, states * sizeof(unsigned long long));
+  if(accept)
+    dfa->accept = accept;
+
+  mask = states * 2 - 1;
+  table = calloc(mask + 1, sizeof(unsigned int));
+  if(!sets || !next || !accept || !table)
+  {
+    perror("realloc");
+    free(table);
+    return -1;
+  }
+
+  for(; i < dfa->states; i++)
+  {
+    unsigned int slot = xdfa_hash(dfa, dfa->sets + i * dfa->words) & mask;
+
+    while(table[slot])
+      slot = (slot + 1) & mask;
+    table[slot] = i + 1;
+  }
+
+  free(dfa->table);
+  dfa->table = table;
+  dfa->mask = mask;
+  return 0;
+}
+
+/* keep the dead and the start state only */
+static void xdfa_flush(xdfa_t *dfa)
+{
+  unsigned int i = 0;
+
+  dfa->states = 2;
+  memset(dfa->table, 0, (dfa->mask + 1) * sizeof(unsigned int));
+  for(; i < dfa->states; i++)
+  {
+    unsigned int slot = xdfa_hash(dfa, dfa->sets + i * dfa->words) 
+                        & dfa->mask;
+
+    while(dfa->table[slot])
+      slot = (slot + 1) & dfa->mask;
+    dfa->table[slot] = i + 1;
+  }
+
+  for(i = 0; i < dfa->class_count; i++)
+    dfa->next[dfa->class_count + i] = XDFA_UNKNOWN;
+  dfa->flushes++;
+}
+
+/* the state of set, a new one if it is not there yet */
+static unsigned int xdfa_state(xdfa_t *dfa, const unsigned long long *set)
+{
+  unsigned int words = dfa->words, slot = 0, id = 0, w = 0, i = 0;
+  unsigned long long hash = xdfa_hash(dfa, set);
+
+  for(slot = hash & dfa->mask; dfa->table[slot]; 
+      slot = (slot + 1) & dfa->mask)
+  {
+    id = dfa->table[slot] - 1;
+    if(!memcmp(dfa->sets + id * words, set, words * sizeof(*set)))
+      return id;
+  }
+
+  /* full, the table has room for twice the states */
+  if(dfa->states * 2 > dfa->mask)
+  {
+    if(dfa->states == XDFA_MAX_STATES)
+      xdfa_flush(dfa);
+    else if(xdfa_grow(dfa, dfa->states * 2) < 0)
+      return XDFA_DEAD;
+
+    for(slot = hash & dfa->mask; dfa->table[slot]; 
+        slot = (slot + 1) & dfa->mask)
+      ;
+  }
+
+  id = dfa->states++;
+  memcpy(dfa->sets + id * words, set, words * sizeof(*set));
+  dfa->table[slot] = id + 1;
+
+  for(i = 0; i < dfa->class_count; i++)
+    dfa->next[id * dfa->class_count + i] = id ? XDFA_UNKNOWN : XDFA_DEAD;
+
+  dfa->accept[id] = 0;
+  for(w = 0; w < words; w++)
+  {
+    unsigned long long word = set[w] & dfa->ends[w];
+
+    for(; word; word &= word - 1)
+      dfa->accept[id] |= 1ULL << dfa->owner[w * 64 + __builtin_ctzll(word)];
+  }
+
+  return id;
+}
+
+int xdfa_compile(xdfa_t *dfa)
+{
+  unsigned int words = 0, p = 0;
+
+  xdfa_release(dfa);
+  xdfa_classes(dfa);
+
+  /* room for the bit a shift moves past the last position */
+  words = dfa->words = dfa->count / 64 + 1;
+  dfa->adv = calloc(dfa->class_count * words, sizeof(unsigned long long));
+  dfa->stay = calloc(dfa->class_count * words, sizeof(unsigned long long));
+  dfa->star = calloc(words, sizeof(unsigned long long));
+  dfa->ends = calloc(words, sizeof(unsigned long long));
+  dfa->scratch = calloc(words, sizeof(unsigned long long));
+  dfa->twin = malloc((dfa->count + 1) * sizeof(unsigned int));
+  if(!dfa->adv || !dfa->stay || !dfa->star || !dfa->ends || !dfa->scratch
+     || !dfa->twin || xdfa_twins(dfa) < 0 || xdfa_grow(dfa, 64) < 0)
+  {
+    perror("calloc");
+    xdfa_release(dfa);
+    return -1;
+  }
+  xdfa_masks(dfa);
+
+  /* the dead state is the empty set, the start has the first tokens */
+  xdfa_state(dfa, dfa->scratch);
+  for(; p < dfa->count; p++)
+  {
+    if(!p || dfa->tokens[p - 1] == XDFA_TOK_END)
+      dfa->scratch[p / 64] |= 1ULL << (p % 64);
+  }
+  xdfa_close(dfa, dfa->scratch);
+
+  /* no glob at all leaves the start dead, it is a state apart anyway */
+  if(xdfa_state(dfa, dfa->scratch) != 1)
+  {
+    dfa->states = 2;
+    memcpy(dfa->sets + words, dfa->scratch, words * sizeof(*dfa->scratch));
+    memset(dfa->next + dfa->class_count, 0, 
+           dfa->class_count * sizeof(unsigned int));
+    dfa->accept[1] = 0;
+  }
+
+  return 0;
+}
+
+unsigned int xdfa_build(xdfa_t *dfa, unsigned int state, int cls)
+{
+  const unsigned long long *from = dfa->sets + state * dfa->words;
+  const unsigned long long *adv = dfa->adv + cls * dfa->words;
+  const unsigned long long *stay = dfa->stay + cls * dfa->words;
+  unsigned long long *set = dfa->scratch, carry = 0;
+  unsigned long flushes = dfa->flushes;
+  unsigned int w = 0, next = 0;
+
+  /* shift-and: the positions taking the byte move on, '*' ones stay */
+  for(; w < dfa->words; w++)
+  {
+    unsigned long long moved = from[w] & adv[w];
+
+    set[w] = moved << 1 | carry | (from[w] & stay[w]);
+    carry = moved >> 63;
+  }
+  xdfa_close(dfa, set);
+
+  /* state is gone if the cache started over */
+  next = xdfa_state(dfa, set);
+  if(flushes == dfa->flushes)
+    dfa->next[state * dfa->class_count + cls] = next;
+
+  return next;
+}
+
+unsigned int xdfa_feed(xdfa_t *dfa, unsigned int state, 
+                       const char *str, size_t len)
+{
+  const unsigned char *ptr = (const unsigned char *)str;
+  const unsigned char *end = ptr + len;
+
+  while(ptr < end && state != XDFA_DEAD)
+    state = xdfa_step(dfa, state, *ptr++);
+
+  return state;
+}
+
+size_t xdfa_bytes(const xdfa_t *dfa)
+{
+  return dfa->size * (sizeof(short) + 1)
+         + (dfa->class_count * 2 + 3) * dfa->words * sizeof(long long)
+         + (size_t)dfa->states * dfa->words * sizeof(long long)
+         + (size_t)dfa->states * dfa->class_count * sizeof(unsigned int)
+         + (dfa->mask + 1) * sizeof(unsigned int);
+}
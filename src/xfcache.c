@@ -0,0 +1,336 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "xfcache.h"
+
+#define XFCACHE_INIT_LINES 256
+
+/* FNV-1a */
+static unsigned int xfcache_hash(const char *str)
+{
+  unsigned int hash = 2166136261u;
+
+  for(; *str; str++)
+  {
+    hash ^= (unsigned char)*str;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+xfcache_t *xfcache_create(unsigned int max_files, size_t max_bytes)
+{
+  xfcache_t *cache = malloc(sizeof(xfcache_t));
+  if(!cache)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(cache, 0, sizeof(xfcache_t));
+  INIT_XLIST_HEAD(&cache->lru);
+  cache->max_files = max_files ? max_files : 1;
+  cache->max_bytes = max_bytes;
+
+  return cache;
+}
+
+static void xfcache_unload(xfcache_t *cache, xfcache_file_t *file)
+{
+  if(file->bytes)
+  {
+    free((void *)file->data);
+    cache->bytes -= file->bytes;
+  }
+
+  file->data = NULL;
+  file->size = 0;
+  file->loaded = 0;
+  file->bytes = 0;
+  file->line_count = 0;
+  file->scanned = 0;
+  file->advised = 0;
+}
+
+static int xfcache_push_line(xfcache_file_t *file, size_t offset)
+{
+  if(file->line_count == file->line_size)
+  {
+    unsigned int size = file->line_size ? file->line_size * 2 
+                                        : XFCACHE_INIT_LINES;
+    size_t *lines = realloc(file->lines, size * sizeof(size_t));
+    if(!lines)
+    {
+      perror("realloc");
+      return -1;
+    }
+
+    file->lines = lines;
+    file->line_size = size;
+  }
+
+  file->lines[file->line_count++] = offset;
+  return 0;
+}
+
+/* 
+ * room for the file as st says it is now, nothing is read yet. the pages
+ * of a big allocation are only taken as the file is read into them
+ */
+static void xfcache_load(xfcache_t *cache, xfcache_file_t *file, 
+                        const struct stat *st)
+{
+  char *data = NULL;
+
+  xfcache_unload(cache, file);
+  file->mtime = st->st_mtim;
+
+  /* an empty file has no line, there is nothing to read */
+  if(!st->st_size)
+  {
+    file->data = "";
+    return;
+  }
+
+  data = malloc(st->st_size);
+  if(!data)
+  {
+    perror("malloc");
+    return;
+  }
+
+  file->data = data;
+  file->size = file->bytes = st->st_size;
+  cache->bytes += file->bytes;
+  xfcache_push_line(file, 0);
+}
+
+/* 
+ * read file up to stop, return -1 if it can't be opened. a file which got
+ * shorter ends where the read did, the next lookup reads it again
+ */
+static int xfcache_read(xfcache_file_t *file, size_t stop)
+{
+  ssize_t n = 0;
+  int fd = -1;
+
+  if(file->loaded >= stop)
+    return 0;
+
+  fd = open(file->path, O_RDONLY);
+  if(fd < 0)
+    return -1;
+
+  while(file->loaded < stop)
+  {
+    n = pread(fd, (char *)file->data + file->loaded, stop - file->loaded, 
+              file->loaded);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n <= 0)
+      break;
+    file->loaded += n;
+  }
+
+  /* the next window is read ahead while this one is searched */
+  if(file->loaded == stop)
+    posix_fadvise(fd, stop, XFCACHE_SCAN, POSIX_FADV_WILLNEED);
+  close(fd);
+
+  if(file->loaded < stop)
+    file->size = file->loaded;
+  return 0;
+}
+
+static void xfcache_drop(xfcache_t *cache, xfcache_file_t *file)
+{
+  xfcache_unload(cache, file);
+  xlist_del(&file->lru);
+  cache->count--;
+
+  free(file->lines);
+  free(file->path);
+  free(file);
+}
+
+/* drop the least recent files, the most recent one always stays */
+static void xfcache_trim(xfcache_t *cache)
+{
+  while(cache->count > 1 && (cache->count > cache->max_files
+                             || cache->bytes > cache->max_bytes))
+  {
+    xfcache_drop(cache, xlist_entry(cache->lru.prev, xfcache_file_t, lru));
+  }
+}
+
+void xfcache_destroy(xfcache_t *cache)
+{
+  if(!cache)
+    return;
+
+  while(!xlist_empty(&cache->lru))
+    xfcache_drop(cache, xlist_entry(cache->lru.next, xfcache_file_t, lru));
+
+  free(cache);
+}
+
+static xfcache_file_t *xfcache_find(xfcache_t *cache, const char *path)
+{
+  unsigned int hash = xfcache_hash(path);
+  xfcache_file_t *file = NULL;
+
+  xlist_for_each_entry(file, &cache->lru, lru)
+  {
+    if(file->hash == hash && !strcmp(file->path, path))
+      return file;
+  }
+
+  return NULL;
+}
+
+xfcache_file_t *xfcache_get(xfcache_t *cache, const char *path)
+{
+  xfcache_file_t *file = xfcache_find(cache, path);
+  struct stat st;
+
+  if(!file)
+  {
+    file = malloc(sizeof(xfcache_file_t));
+    if(!file)
+    {
+      perror("malloc");
+      return NULL;
+    }
+
+    memset(file, 0, sizeof(xfcache_file_t));
+    file->path = strdup(path);
+    if(!file->path)
+    {
+      perror("strdup");
+      free(file);
+      return NULL;
+    }
+
+    file->hash = xfcache_hash(path);
+    xlist_add(&file->lru, &cache->lru);
+    cache->count++;
+  }
+  else
+  {
+    xlist_del(&file->lru);
+    xlist_add(&file->lru, &cache->lru);
+  }
+
+  /* a file which changed or came back since is read again */
+  if(stat(path, &st) < 0 || !S_ISREG(st.st_mode))
+    xfcache_unload(cache, file);
+  else if(!file->data || st.st_mtim.tv_sec != file->mtime.tv_sec 
+          || st.st_mtim.tv_nsec != file->mtime.tv_nsec
+          || (size_t)st.st_size != file->size)
+    xfcache_load(cache, file, &st);
+
+  xfcache_trim(cache);
+  return file;
+}
+
+void xfcache_prefetch(xfcache_t *cache, const char *path)
+{
+  xfcache_file_t *file = xfcache_find(cache, path);
+  int fd = -1;
+
+  if(file && file->advised)
+    return;
+
+  file = xfcache_get(cache, path);
+  if(!file || !file->data)
+    return;
+
+  /* the page cache keeps what is read ahead, the fd is not needed after */
+  fd = open(path, O_RDONLY);
+  if(fd < 0)
+    return;
+
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  close(fd);
+  file->advised = 1;
+}
+
+long xfcache_line(xfcache_file_t *file, unsigned int n, const char **text)
+{
+  size_t stop = 0, start = 0, end = 0;
+
+  if(!file->data || !n)
+    return -1;
+
+  /* the start of line n + 1 ends line n, the scan stops at the budget */
+  if(file->line_count <= n && file->scanned < file->size)
+  {
+    stop = file->scanned + XFCACHE_SCAN;
+    if(stop > file->size)
+      stop = file->size;
+
+    if(xfcache_read(file, stop) < 0)
+      return -1;
+    if(stop > file->size)
+      stop = file->size;
+
+    while(file->line_count <= n && file->scanned < stop)
+    {
+      const char *nl = memchr(file->data + file->scanned, '\n', 
+                              stop - file->scanned);
+      if(!nl)
+      {
+        file->scanned = stop;
+        break;
+      }
+
+      file->scanned = nl - file->data + 1;
+      if(file->scanned < file->size 
+         && xfcache_push_line(file, file->scanned) < 0)
+        return -1;
+    }
+
+    if(file->line_count <= n && file->scanned < file->size)
+      return XFCACHE_AGAIN;
+  }
+
+  if(n > file->line_count)
+    return -1;
+
+  start = file->lines[n - 1];
+  end = n < file->line_count ? file->lines[n] : file->size;
+  if(end > start && file->data[end - 1] == '\n')
+    end--;
+  if(end > start && file->data[end - 1] == '\r')
+    end--;
+
+  *text = file->data + start;
+  return end - start;
+}
@@ -0,0 +1,136 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xhset.h"
+
+#define XHSET_INIT_SLOTS 64
+
+void xhset_init(xhset_t *set)
+{
+  memset(set, 0, sizeof(xhset_t));
+}
+
+void xhset_release(xhset_t *set)
+{
+  free(set->slots);
+  xhset_init(set);
+}
+
+void xhset_flush(xhset_t *set)
+{
+  if(set->slots)
+    memset(set->slots, 0, (set->mask + 1) * sizeof(unsigned long long));
+
+  set->count = 0;
+  set->zero = 0;
+}
+
+/* the keys may share their low bits, they are mixed before the mask */
+static unsigned int xhset_slot(const xhset_t *set, unsigned long long key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+
+  return key & set->mask;
+}
+
+/* the slot holding key or the free one it goes to */
+static unsigned long long *xhset_find(const xhset_t *set, 
+                                      unsigned long long key)
+{
+  unsigned int i = xhset_slot(set, key);
+
+  while(set->slots[i] && set->slots[i] != key)
+    i = (i + 1) & set->mask;
+
+  return &set->slots[i];
+}
+
+/* double the slots and put the keys again, the load stays under 1/2 */
+static int xhset_grow(xhset_t *set)
+{
+  unsigned int size = set->slots ? (set->mask + 1) * 2 : XHSET_INIT_SLOTS;
+  unsigned long long *old = set->slots;
+  unsigned int old_size = set->slots ? set->mask + 1 : 0, i = 0;
+
+  set->slots = calloc(size, sizeof(unsigned long long));
+  if(!set->slots)
+  {
+    perror("calloc");
+    set->slots = old;
+    return -1;
+  }
+
+  set->mask = size - 1;
+  for(; i < old_size; i++)
+  {
+    if(old[i])
+      *xhset_find(set, old[i]) = old[i];
+  }
+
+  free(old);
+  return 0;
+}
+
+int xhset_add(xhset_t *set, unsigned long long key)
+{
+  unsigned long long *slot = NULL;
+
+  if(!key)
+  {
+    if(set->zero)
+      return 0;
+
+    set->zero = 1;
+    set->count++;
+    return 1;
+  }
+
+  if((!set->slots || (set->count + 1) * 2 > set->mask + 1)
+     && xhset_grow(set) < 0)
+    return -1;
+
+  slot = xhset_find(set, key);
+  if(*slot)
+    return 0;
+
+  *slot = key;
+  set->count++;
+  return 1;
+}
+
+int xhset_has(const xhset_t *set, unsigned long long key)
+{
+  if(!key)
+    return set->zero;
+
+  return set->slots && *xhset_find(set, key) == key;
+}
+
+size_t xhset_bytes(const xhset_t *set)
+{
+  return set->slots ? (set->mask + 1) * sizeof(unsigned long long) : 0;
+}
@@ -0,0 +1,272 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "xintern.h"
+
+#define XINTERN_INIT_SIZE 64
+
+/* FNV-1a, good enough for paths */
+static unsigned int xintern_hash(const char *str, int len)
+{
+  unsigned int hash = 2166136261u;
+  int i = 0;
+
+  for(; i < len; i++)
+  {
+    hash ^= (unsigned char)str[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static int xintern_alloc(xintern_t *tab, unsigned int size)
+{
+  tab->entries = calloc(size, sizeof(xintern_entry_t));
+  tab->slots = calloc(size * 2, sizeof(unsigned int));
+  if(!tab->entries || !tab->slots)
+  {
+    perror("calloc");
+    free(tab->entries);
+    free(tab->slots);
+    return -1;
+  }
+
+  tab->size = size;
+  tab->slot_mask = size * 2 - 1;
+  tab->count = 0;
+  tab->bytes = size * (sizeof(xintern_entry_t) + 2 * sizeof(unsigned int));
+
+  return 0;
+}
+
+xintern_t *xintern_create(xintern_derive_f derive)
+{
+  xintern_t *tab = malloc(sizeof(xintern_t));
+  if(!tab)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(tab, 0, sizeof(xintern_t));
+  if(xintern_alloc(tab, XINTERN_INIT_SIZE) < 0)
+  {
+    free(tab);
+    return NULL;
+  }
+
+  tab->derive = derive;
+  return tab;
+}
+
+static void xintern_release(xintern_t *tab)
+{
+  unsigned int i = 0;
+
+  for(; i < tab->count; i++)
+  {
+    if(tab->entries[i].alias != tab->entries[i].str)
+      free(tab->entries[i].alias);
+    free(tab->entries[i].str);
+  }
+
+  free(tab->entries);
+  free(tab->slots);
+  tab->entries = NULL;
+  tab->slots = NULL;
+}
+
+void xintern_destroy(xintern_t *tab)
+{
+  if(!tab)
+    return;
+
+  xintern_release(tab);
+  free(tab);
+}
+
+void xintern_flush(xintern_t *tab)
+{
+  if(!tab)
+    return;
+
+  xintern_release(tab);
+  xintern_alloc(tab, XINTERN_INIT_SIZE);
+}
+
+/* return the slot which holds str or the empty one to insert it */
+static unsigned int *xintern_slot(xintern_t *tab, const char *str,
+                                  int len, unsigned int hash)
+{
+  unsigned int i = hash & tab->slot_mask;
+
+  while(tab->slots[i])
+  {
+    xintern_entry_t *entry = &tab->entries[tab->slots[i] - 1];
+    if(entry->hash == hash && entry->len == len
+       && memcmp(entry->str, str, len) == 0)
+      break;
+
+    i = (i + 1) & tab->slot_mask;
+  }
+
+  return &tab->slots[i];
+}
+
+/* double the entries and rehash, load factor is kept under 1/2 */
+static int xintern_grow(xintern_t *tab)
+{
+  unsigned int i = 0;
+  unsigned int size = tab->size * 2;
+  unsigned int *slots = NULL;
+  xintern_entry_t *entries = NULL;
+
+  entries = realloc(tab->entries, size * sizeof(xintern_entry_t));
+  if(!entries)
+  {
+    perror("realloc");
+    return -1;
+  }
+  tab->entries = entries;
+
+  slots = calloc(size * 2, sizeof(unsigned int));
+  if(!slots)
+  {
+    perror("calloc");
+    return -1;
+  }
+
+  free(tab->slots);
+  tab->slots = slots;
+  tab->slot_mask = size * 2 - 1;
+  tab->bytes += tab->size * (sizeof(xintern_entry_t) + 2 * sizeof(unsigned int));
+  tab->size = size;
+
+  for(; i < tab->count; i++)
+  {
+    xintern_entry_t *entry = &tab->entries[i];
+    *xintern_slot(tab, entry->str, entry->len, entry->hash) = i + 1;
+  }
+
+  return 0;
+}
+
+unsigned int xintern_find(xintern_t *tab, const char *str, int len)
+{
+  unsigned int *slot = NULL;
+
+  if(!tab || !str)
+    return XINTERN_NONE;
+
+  if(len < 0)
+    len = strlen(str);
+
+  slot = xintern_slot(tab, str, len, xintern_hash(str, len));
+  return *slot ? *slot - 1 : XINTERN_NONE;
+}
+
+unsigned int xintern_add(xintern_t *tab, const char *str, int len)
+{
+  unsigned int hash = 0;
+  unsigned int *slot = NULL;
+  xintern_entry_t *entry = NULL;
+
+  if(!tab || !str)
+    return XINTERN_NONE;
+
+  if(len < 0)
+    len = strlen(str);
+
+  hash = xintern_hash(str, len);
+  slot = xintern_slot(tab, str, len, hash);
+  if(*slot)
+    return *slot - 1;
+
+  if(tab->count == tab->size)
+  {
+    if(xintern_grow(tab) < 0)
+      return XINTERN_NONE;
+    slot = xintern_slot(tab, str, len, hash);
+  }
+
+  entry = &tab->entries[tab->count];
+  entry->str = strndup(str, len);
+  if(!entry->str)
+  {
+    perror("strndup");
+    return XINTERN_NONE;
+  }
+
+  entry->hash = hash;
+  entry->len = len;
+  entry->alias = NULL;
+  if(tab->derive)
+    entry->alias = tab->derive(entry->str);
+  if(!entry->alias)
+    entry->alias = entry->str;
+
+  tab->bytes += len + 1;
+  if(entry->alias != entry->str)
+    tab->bytes += strlen(entry->alias) + 1;
+
+  *slot = ++tab->count;
+  return tab->count - 1;
+}
+
+const char *xintern_str(xintern_t *tab, unsigned int id)
+{
+  assert(tab);
+
+  if(id >= tab->count)
+    return NULL;
+
+  return tab->entries[id].str;
+}
+
+const char *xintern_alias(xintern_t *tab, unsigned int id)
+{
+  assert(tab);
+
+  if(id >= tab->count)
+    return NULL;
+
+  return tab->entries[id].alias;
+}
+
+unsigned int xintern_count(xintern_t *tab)
+{
+  assert(tab);
+
+  return tab->count;
+}
+
+size_t xintern_bytes(xintern_t *tab)
+{
+  assert(tab);
+
+  return tab->bytes;
+}
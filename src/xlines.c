@@ -0,0 +1,140 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "xlines.h"
+
+void xlines_init(xlines_t *lines)
+{
+  memset(lines, 0, sizeof(xlines_t));
+}
+
+void xlines_release(xlines_t *lines)
+{
+  free(lines->buf);
+  xlines_init(lines);
+}
+
+ssize_t xlines_read(xlines_t *lines, int fd)
+{
+  ssize_t n = 0;
+
+  /* the partial line moves to the front, lines handed out are done */
+  if(lines->start)
+  {
+    memmove(lines->buf, lines->buf + lines->start, lines->len - lines->start);
+    lines->len -= lines->start;
+    lines->scan -= lines->start;
+    lines->start = 0;
+  }
+
+  /* a line with no end in sight keeps its head, the rest goes */
+  if(lines->len >= XLINES_MAX && lines->scan == lines->len)
+  {
+    lines->len = lines->scan = XLINES_MAX;
+    lines->cut = 1;
+  }
+
+  /* a byte is kept for the '\0' of xlines_rest() */
+  if(lines->size - lines->len < XLINES_READ + 1)
+  {
+    size_t size = lines->size ? lines->size * 2 : XLINES_READ * 2;
+    char *buf = NULL;
+
+    while(size - lines->len < XLINES_READ + 1)
+      size *= 2;
+
+    buf = realloc(lines->buf, size);
+    if(!buf)
+    {
+      perror("realloc");
+      return -1;
+    }
+
+    lines->buf = buf;
+    lines->size = size;
+  }
+
+  do
+  {
+    n = read(fd, lines->buf + lines->len, XLINES_READ);
+  }while(n < 0 && errno == EINTR);
+
+  if(n <= 0)
+    return n;
+
+  /* what is read of a cut line is dropped up to its '\n' */
+  if(lines->cut)
+  {
+    char *from = lines->buf + lines->len;
+    char *nl = memchr(from, '\n', n);
+
+    if(!nl)
+      return n;
+
+    memmove(from, nl, from + n - nl);
+    lines->len += from + n - nl;
+    lines->cut = 0;
+    return n;
+  }
+
+  lines->len += n;
+  return n;
+}
+
+char *xlines_next(xlines_t *lines)
+{
+  char *line = lines->buf + lines->start;
+  char *nl = NULL;
+
+  if(lines->scan < lines->len)
+    nl = memchr(lines->buf + lines->scan, '\n', lines->len - lines->scan);
+
+  if(!nl)
+  {
+    lines->scan = lines->len;
+    return NULL;
+  }
+
+  *nl = '\0';
+  if(nl > line && nl[-1] == '\r')
+    nl[-1] = '\0';
+
+  lines->start = lines->scan = nl - lines->buf + 1;
+  return line;
+}
+
+char *xlines_rest(xlines_t *lines)
+{
+  char *line = lines->buf + lines->start;
+
+  if(lines->start >= lines->len)
+    return NULL;
+
+  lines->buf[lines->len] = '\0';
+  lines->start = lines->scan = lines->len;
+  return line;
+}
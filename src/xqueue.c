@@ -13,6 +13,18 @@ static unsigned int __xqueue_enqueue(xqueue_t *head, xqnode_t *qnode)
   return head->qnode_num;
 }
 
+/* ring nodes go back to the pool, the others are freed */
+void xqueue_release(xqueue_t *head, xqnode_t *node)
+{
+  if(head->pool)
+  {
+    node->data = NULL;
+    xlist_add_tail(&node->node, &head->free_nodes);
+  }
+  else
+    free(node);
+}
+
 xqnode_t *xqueue_dequeue(xqueue_t *head)
 {
   if(head->qnode_num == 0)
@@ -72,13 +84,70 @@ xqueue_t *xqueue_create(int size, xqueue_free_f free)
     
   head->qnode_num = 0;
   head->free = free;
+  INIT_XLIST_HEAD(&head->free_nodes);
   
   return head;
 }
 
+xqueue_t *xqueue_create_ring(int size, xqueue_free_f free)
+{
+  int i = 0;
+  xqueue_t *head = NULL;
+  
+  if(size <= 0)
+    size = AQUEUE_MAX_NODES;
+  
+  head = xqueue_create(size, free);
+  if(!head)
+    return NULL;
+  
+  head->pool = calloc(size, sizeof(xqnode_t));
+  if(!head->pool)
+  {
+    perror("calloc");
+    free(head);
+    return NULL;
+  }
+  
+  for(; i < size; i++)
+    xlist_add_tail(&head->pool[i].node, &head->free_nodes);
+  
+  return head;
+}
+
+/* overwrite the oldest entry of a full ring */
+static int xqueue_ring_enqueue(xqueue_t *head, void *data)
+{
+  xqnode_t *qnode = NULL;
+  
+  if(head->qnode_num < head->max_qnode_num)
+  {
+    /* a dequeued node which was not released is missing from the pool */
+    qnode = (xqnode_t *)xlist_get(&head->free_nodes);
+    if(!qnode)
+      return -1;
+    qnode->data = data;
+    return __xqueue_enqueue(head, qnode);
+  }
+  
+  qnode = xlist_entry(head->node.next, xqnode_t, node);
+  if(head->free)
+    head->free(qnode->data);
+  
+  qnode->data = data;
+  xlist_del(&qnode->node);
+  xlist_add_tail(&qnode->node, &head->node);
+  head->overwritten++;
+  
+  return head->qnode_num;
+}
+
 int xqueue_enqueue(xqueue_t *head, void *data)
 { 
   xqnode_t *qnode = NULL;
+  if(head->pool)
+    return xqueue_ring_enqueue(head, data);
+  
   if(head->max_qnode_num 
     && head->qnode_num >= head->max_qnode_num)
     return -1;
@@ -108,7 +177,7 @@ void xqueue_handle(xqueue_t *head, xqueue_handle_f handle)
     handle(node->data);
     if(head->free)
       head->free(node->data);
-    free(node);
+    xqueue_release(head, node);
   }
 }
 
@@ -123,7 +192,7 @@ void xqueue_flush(xqueue_t *head)
   {
     if(head->free)
       head->free(node->data);
-    free(node);
+    xqueue_release(head, node);
   }
 }
 
@@ -133,6 +202,7 @@ void xqueue_destroy(xqueue_t *head)
     return;
   
   xqueue_flush(head);
+  free(head->pool);
   free(head);
 }
 
@@ -143,6 +213,13 @@ unsigned int xqueue_nodes(xqueue_t *head)
   return head->qnode_num;
 }
 
+unsigned int xqueue_overwritten(xqueue_t *head)
+{
+  assert(head);
+  
+  return head->overwritten;
+}
+
 #define TEST 1
 #ifdef TEST
 static void dump_string(void *str)
@@ -169,4 +246,45 @@ void test_queue()
   xqueue_destroy(queue);
 }
 
+void test_ring_queue()
+{
+  xqueue_t *queue = xqueue_create_ring(2, free);
+  xqueue_enqueue(queue, strdup("hello"));
+  xqueue_enqueue(queue, strdup("world"));
+  
+  /* "hello" is overwritten */
+  xqueue_enqueue(queue, strdup("again"));
+  printf("xqueue_nodes %d, overwritten %d\n", xqueue_nodes(queue),
+         xqueue_overwritten(queue));
+  
+  xqueue_traverse(queue, dump_string);
+  xqueue_destroy(queue);
+}
+
+void test_ring_queue_reuse()
+{
+  xqueue_t *queue = xqueue_create_ring(2, free);
+  xqnode_t *node = NULL;
+  int i = 0;
+
+  /* a dequeued node goes back to the pool and is enqueued again */
+  for(; i < 5; i++)
+  {
+    xqueue_enqueue(queue, strdup("hello"));
+    xqueue_enqueue(queue, strdup("world"));
+
+    node = xqueue_dequeue(queue);
+    assert(node != NULL);
+    free(node->data);
+    xqueue_release(queue, node);
+
+    assert(xqueue_enqueue(queue, strdup("again")) == 2);
+    xqueue_flush(queue);
+  }
+
+  assert(xqueue_overwritten(queue) == 0);
+  printf("xqueue_nodes %d\n", xqueue_nodes(queue));
+  xqueue_destroy(queue);
+}
+
 #endif
@@ -0,0 +1,537 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <limits.h>
+
+#include "xdebug.h"
+#include "xscreen.h"
+#include "xwidth.h"
+
+#define XSCREEN_PRINT_SIZE 512
+
+xscreen_t *xscreen_create(void)
+{
+  xscreen_t *scr = malloc(sizeof(xscreen_t));
+  if(!scr)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(scr, 0, sizeof(xscreen_t));
+  scr->full = 1;
+  scr->scroll_top = INT_MAX;
+  scr->scroll_bottom = INT_MAX;
+
+  return scr;
+}
+
+static void xscreen_free_lines(xsline_t *lines, int height)
+{
+  int i = 0;
+
+  if(!lines)
+    return;
+
+  for(; i < height; i++)
+    free(lines[i].text);
+  free(lines);
+}
+
+void xscreen_destroy(xscreen_t *scr)
+{
+  if(!scr)
+    return;
+
+  xscreen_free_lines(scr->front, scr->height);
+  xscreen_free_lines(scr->back, scr->height);
+  free(scr->out);
+  free(scr);
+}
+
+void xscreen_resize(xscreen_t *scr, int width, int height)
+{
+  xsline_t *front = NULL, *back = NULL;
+
+  if(width == scr->width && height == scr->height)
+    return;
+
+  front = calloc(height, sizeof(xsline_t));
+  back = calloc(height, sizeof(xsline_t));
+  if(!front || !back)
+  {
+    perror("calloc");
+    free(front);
+    free(back);
+    return;
+  }
+
+  xscreen_free_lines(scr->front, scr->height);
+  xscreen_free_lines(scr->back, scr->height);
+
+  scr->front = front;
+  scr->back = back;
+  scr->width = width;
+  scr->height = height;
+  scr->cur = 0;
+  scr->full = 1;
+}
+
+void xscreen_invalidate(xscreen_t *scr)
+{
+  scr->full = 1;
+}
+
+void xscreen_set_scroll(xscreen_t *scr, int top, int bottom)
+{
+  scr->scroll_top = top < 0 ? 0 : top;
+  scr->scroll_bottom = bottom;
+}
+
+/* the line below the scroll region */
+static int xscreen_scroll_bottom(xscreen_t *scr)
+{
+  return scr->scroll_bottom < scr->height ? scr->scroll_bottom : scr->height;
+}
+
+void xscreen_begin(xscreen_t *scr)
+{
+  int i = 0;
+
+  for(; i < scr->height; i++)
+  {
+    scr->back[i].len = 0;
+    scr->back[i].cols = 0;
+  }
+
+  scr->cur = 0;
+}
+
+static int xsline_reserve(xsline_t *line, size_t len)
+{
+  char *text = NULL;
+  size_t size = line->size ? line->size : 128;
+
+  if(line->len + len + 1 <= line->size)
+    return 0;
+
+  while(size < line->len + len + 1)
+    size *= 2;
+
+  text = realloc(line->text, size);
+  if(!text)
+  {
+    perror("realloc");
+    return -1;
+  }
+
+  line->text = text;
+  line->size = size;
+  return 0;
+}
+
+/* 
+ * copy str into line, the escape sequences are kept, text over width is not.
+ * a wide character which does not fit in the last column fills the line
+ */
+static void xsline_append(xsline_t *line, const char *str, int len, int width)
+{
+  const char *end = str + len;
+  int skip = line->cols >= width;
+
+  if(xsline_reserve(line, len) < 0)
+    return;
+
+  while(str < end)
+  {
+    size_t ascii = 0;
+    const char *esc = NULL;
+    int n = 0, cols = 0;
+
+    if(*str == '\033' && str + 1 < end && str[1] == '[')
+    {
+      const char *seq = str + 2;
+      while(seq < end && (*seq < '@' || *seq > '~'))
+        seq++;
+      if(seq < end)
+        seq++;
+
+      memcpy(line->text + line->len, str, seq - str);
+      line->len += seq - str;
+      str = seq;
+      continue;
+    }
+
+    /* a run of ascii up to the next escape is one column a byte */
+    ascii = xwidth_ascii(str, end - str);
+    if(ascii)
+    {
+      esc = memchr(str + 1, '\033', ascii - 1);
+      if(esc)
+        ascii = esc - str;
+
+      n = ascii;
+      if(n > width - line->cols)
+        n = width - line->cols > 0 ? width - line->cols : 0;
+
+      memcpy(line->text + line->len, str, n);
+      line->len += n;
+      line->cols += n;
+      skip = line->cols >= width;
+      str += ascii;
+      continue;
+    }
+
+    /* a zero width character goes with the one before it */
+    n = xwidth_next(str, end - str, &cols);
+    if(cols)
+      skip = line->cols + cols > width;
+
+    if(!skip)
+    {
+      memcpy(line->text + line->len, str, n);
+      line->len += n;
+      line->cols += cols;
+    }
+    else
+      line->cols = width;
+    str += n;
+  }
+
+  line->text[line->len] = '\0';
+}
+
+void xscreen_printf(xscreen_t *scr, const xcolor_t *color, const char *fmt, ...)
+{
+  char buf[XSCREEN_PRINT_SIZE];
+  char *str = buf;
+  va_list args;
+  int len = 0;
+
+  if(scr->cur >= scr->height)
+    return;
+
+  va_start(args, fmt);
+  len = xcolor_vsnprintf(buf, sizeof(buf), color, fmt, args);
+  va_end(args);
+  if(len < 0)
+    return;
+
+  if(len >= sizeof(buf))
+  {
+    str = malloc(len + 1);
+    if(!str)
+    {
+      perror("malloc");
+      return;
+    }
+
+    va_start(args, fmt);
+    xcolor_vsnprintf(str, len + 1, color, fmt, args);
+    va_end(args);
+  }
+
+  xsline_append(&scr->back[scr->cur], str, len, scr->width);
+
+  if(str != buf)
+    free(str);
+}
+
+void xscreen_newline(xscreen_t *scr)
+{
+  if(scr->cur < scr->height)
+    scr->cur++;
+}
+
+int xscreen_lines_left(xscreen_t *scr)
+{
+  return scr->height - scr->cur;
+}
+
+/* append to the output buffer */
+static void xscreen_out(xscreen_t *scr, const char *str, size_t len)
+{
+  if(scr->out_len + len > scr->out_size)
+  {
+    size_t size = scr->out_size ? scr->out_size : 4096;
+    char *out = NULL;
+
+    while(size < scr->out_len + len)
+      size *= 2;
+
+    out = realloc(scr->out, size);
+    if(!out)
+    {
+      perror("realloc");
+      return;
+    }
+
+    scr->out = out;
+    scr->out_size = size;
+  }
+
+  memcpy(scr->out + scr->out_len, str, len);
+  scr->out_len += len;
+}
+
+static void xscreen_out_move(xscreen_t *scr, int y)
+{
+  char move[16];
+  int len = snprintf(move, sizeof(move), "\033[%d;1H", y + 1);
+
+  xscreen_out(scr, move, len);
+}
+
+static int xsline_equal(const xsline_t *a, const xsline_t *b)
+{
+  return a->len == b->len && (!a->len || !memcmp(a->text, b->text, a->len));
+}
+
+/* 
+ * the shift of the region if the back lines are the front ones moved up,
+ * 0 if they are not. a shift needs more lines kept than scrolled in
+ */
+static int xscreen_find_scroll(xscreen_t *scr)
+{
+  int top = scr->scroll_top, n = xscreen_scroll_bottom(scr) - top;
+  int k = 1, i = 0;
+
+  if(n < 2)
+    return 0;
+
+  for(; k < n - k; k++)
+  {
+    if(!scr->back[top].len || !xsline_equal(&scr->back[top], &scr->front[top + k]))
+      continue;
+
+    for(i = 1; i < n - k; i++)
+    {
+      if(!xsline_equal(&scr->back[top + i], &scr->front[top + i + k]))
+        break;
+    }
+
+    if(i == n - k)
+      return k;
+  }
+
+  return 0;
+}
+
+/* let the terminal scroll the region up by k, the front follows it */
+static void xscreen_out_scroll(xscreen_t *scr, int k)
+{
+  int top = scr->scroll_top, bottom = xscreen_scroll_bottom(scr);
+  xsline_t *gone = NULL;
+  char seq[32];
+  int len = 0, i = 0;
+
+  gone = malloc(k * sizeof(xsline_t));
+  if(!gone)
+  {
+    perror("malloc");
+    return;
+  }
+
+  /* the region, its last line, k line feeds, then the region is reset */
+  len = snprintf(seq, sizeof(seq), "\033[%d;%dr\033[%d;1H", 
+                 top + 1, bottom, bottom);
+  xscreen_out(scr, seq, len);
+  for(i = 0; i < k; i++)
+    xscreen_out(scr, "\n", 1);
+  xscreen_out(scr, "\033[r", 3);
+
+  /* the lines scrolled in are blank */
+  memcpy(gone, scr->front + top, k * sizeof(xsline_t));
+  memmove(scr->front + top, scr->front + top + k, 
+          (bottom - top - k) * sizeof(xsline_t));
+  memcpy(scr->front + bottom - k, gone, k * sizeof(xsline_t));
+  for(i = bottom - k; i < bottom; i++)
+  {
+    scr->front[i].len = 0;
+    scr->front[i].cols = 0;
+  }
+
+  free(gone);
+  scr->scrolls++;
+}
+
+static unsigned long long xscreen_now_us()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* 
+ * write without blocking, the fd is shared with the shell so it is only
+ * non-blocking for the time of the write
+ */
+static ssize_t xscreen_write(xscreen_t *scr, int fd)
+{
+  int flags = fcntl(fd, F_GETFL);
+  int ret = 0;
+
+  if(flags >= 0 && !(flags & O_NONBLOCK))
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+  while(scr->out_pos < scr->out_len)
+  {
+    ssize_t n = write(fd, scr->out + scr->out_pos, 
+                      scr->out_len - scr->out_pos);
+    scr->writes++;
+    if(n < 0)
+    {
+      if(errno == EINTR)
+        continue;
+      if(errno != EAGAIN && errno != EWOULDBLOCK)
+        ret = -1;
+      break;
+    }
+
+    scr->out_pos += n;
+    if(scr->congested)
+      scr->congested_bytes += n;
+  }
+
+  if(flags >= 0 && !(flags & O_NONBLOCK))
+    fcntl(fd, F_SETFL, flags);
+
+  if(ret < 0)
+    return ret;
+
+  if(scr->out_pos < scr->out_len && !scr->congested)
+  {
+    /* the kernel buffer is full, what it takes from now is the rate */
+    scr->congested = 1;
+    scr->congested_at = xscreen_now_us();
+    scr->congested_bytes = 0;
+  }
+  else if(scr->out_pos == scr->out_len && scr->congested)
+  {
+    unsigned long long elapsed = xscreen_now_us() - scr->congested_at;
+
+    scr->congested = 0;
+    if(elapsed && scr->congested_bytes)
+      scr->rate = scr->congested_bytes * 1000000.0 / elapsed;
+  }
+  else if(scr->out_pos == scr->out_len && scr->rate)
+  {
+    /* a frame went out at once, the link may be faster now, probe it */
+    scr->rate *= 1.1;
+  }
+
+  return ret;
+}
+
+unsigned long long xscreen_pace_us(xscreen_t *scr)
+{
+  if(!scr->rate)
+    return 0;
+
+  /* stay below the rate, so the backlog shrinks */
+  return scr->last_len * 1000000.0 / (scr->rate * 0.8);
+}
+
+size_t xscreen_pending(xscreen_t *scr)
+{
+  return scr->out_len - scr->out_pos;
+}
+
+size_t xscreen_drain(xscreen_t *scr, int fd)
+{
+  if(xscreen_pending(scr) && xscreen_write(scr, fd) < 0)
+  {
+    scr->out_pos = scr->out_len;
+    scr->full = 1;
+  }
+
+  return xscreen_pending(scr);
+}
+
+size_t xscreen_flush(xscreen_t *scr, int fd)
+{
+  xsline_t *tmp = NULL;
+  size_t pending = xscreen_pending(scr);
+  int y = 0;
+
+  /* a pending tail goes out before the new frame */
+  memmove(scr->out, scr->out + scr->out_pos, pending);
+  scr->out_len = pending;
+  scr->out_pos = 0;
+  if(scr->full)
+    xscreen_out(scr, SCREEN_CLEAR, strlen(SCREEN_CLEAR));
+  else if(scr->scroll_top < xscreen_scroll_bottom(scr))
+  {
+    int k = xscreen_find_scroll(scr);
+    if(k)
+      xscreen_out_scroll(scr, k);
+  }
+
+  for(; y < scr->height; y++)
+  {
+    xsline_t *back = &scr->back[y];
+    xsline_t *front = &scr->front[y];
+
+    if(scr->full)
+    {
+      if(!back->len)
+        continue;
+    }
+    else if(back->len == front->len
+            && (!back->len || !memcmp(back->text, front->text, back->len)))
+      continue;
+
+    /* move to the line, write it and erase what the old one left */
+    xscreen_out_move(scr, y);
+    xscreen_out(scr, back->text, back->len);
+    if(!scr->full)
+      xscreen_out(scr, "\033[K", 3);
+  }
+
+  tmp = scr->front;
+  scr->front = scr->back;
+  scr->back = tmp;
+  scr->full = 0;
+
+  if(scr->out_len == pending)
+    return 0;
+
+  scr->frames++;
+  scr->last_len = scr->out_len - pending;
+  if(xscreen_write(scr, fd) < 0)
+  {
+    /* the terminal is out of step, repaint it all the next time */
+    scr->out_pos = scr->out_len;
+    scr->full = 1;
+    return 0;
+  }
+
+  return scr->out_len - pending;
+}
@@ -0,0 +1,510 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "xskiplist.h"
+
+static xsknode_t *xsknode_create(unsigned int level, unsigned int id)
+{
+  xsknode_t *node = malloc(sizeof(xsknode_t) + level * sizeof(xsklink_t));
+  if(!node)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(node, 0, sizeof(xsknode_t) + level * sizeof(xsklink_t));
+  node->id = id;
+  node->level = level;
+
+  return node;
+}
+
+/* p = 1/4, xorshift is plenty for this */
+static unsigned int xskiplist_random_level(xskiplist_t *list)
+{
+  unsigned int level = 1;
+  unsigned int x = list->seed;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  list->seed = x;
+
+  while((x & 3) == 0 && level < XSKIPLIST_MAX_LEVEL)
+  {
+    level++;
+    x >>= 2;
+  }
+
+  return level;
+}
+
+xskiplist_t *xskiplist_create(xskiplist_cmp_f cmp, void *ctx)
+{
+  xskiplist_t *list = NULL;
+
+  assert(cmp);
+  list = malloc(sizeof(xskiplist_t));
+  if(!list)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(list, 0, sizeof(xskiplist_t));
+  list->head = xsknode_create(XSKIPLIST_MAX_LEVEL, 0);
+  if(!list->head)
+  {
+    free(list);
+    return NULL;
+  }
+
+  list->level = 1;
+  list->seed = 2463534242u;
+  list->cmp = cmp;
+  list->ctx = ctx;
+
+  return list;
+}
+
+void xskiplist_flush(xskiplist_t *list)
+{
+  xsknode_t *node = NULL, *next = NULL;
+  unsigned int i = 0;
+
+  if(!list)
+    return;
+
+  for(node = xskiplist_first(list); node; node = next)
+  {
+    next = xskiplist_next(node);
+    free(node);
+  }
+
+  memset(list->head->link, 0, XSKIPLIST_MAX_LEVEL * sizeof(xsklink_t));
+  for(i = 0; i < XSKIPLIST_SUMS; i++)
+    list->sum[i] = 0;
+
+  list->level = 1;
+  list->count = 0;
+  list->bytes = 0;
+}
+
+void xskiplist_destroy(xskiplist_t *list)
+{
+  if(!list)
+    return;
+
+  xskiplist_flush(list);
+  free(list->head);
+  free(list);
+}
+
+long xskiplist_insert(xskiplist_t *list, unsigned int id)
+{
+  xsknode_t *update[XSKIPLIST_MAX_LEVEL];
+  unsigned int rank[XSKIPLIST_MAX_LEVEL];
+  unsigned int sum[XSKIPLIST_MAX_LEVEL][XSKIPLIST_SUMS];
+  unsigned int weight[XSKIPLIST_SUMS] = {0};
+  xsknode_t *node = list->head;
+  unsigned int level = 0;
+  int i = 0, n = 0;
+
+  for(i = list->level - 1; i >= 0; i--)
+  {
+    rank[i] = (i == list->level - 1) ? 0 : rank[i + 1];
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+      sum[i][n] = (i == list->level - 1) ? 0 : sum[i + 1][n];
+
+    while(node->link[i].next
+          && list->cmp(list->ctx, node->link[i].next->id, id) < 0)
+    {
+      rank[i] += node->link[i].span;
+      for(n = 0; n < XSKIPLIST_SUMS; n++)
+        sum[i][n] += node->link[i].sum[n];
+      node = node->link[i].next;
+    }
+    update[i] = node;
+  }
+
+  level = xskiplist_random_level(list);
+  if(level > list->level)
+  {
+    for(i = list->level; i < level; i++)
+    {
+      rank[i] = 0;
+      update[i] = list->head;
+      update[i]->link[i].span = list->count;
+      for(n = 0; n < XSKIPLIST_SUMS; n++)
+      {
+        sum[i][n] = 0;
+        update[i]->link[i].sum[n] = list->sum[n];
+      }
+    }
+    list->level = level;
+  }
+
+  node = xsknode_create(level, id);
+  if(!node)
+    return -1;
+  list->bytes += sizeof(xsknode_t) + level * sizeof(xsklink_t);
+
+  if(list->weigh)
+    list->weigh(list->ctx, id, weight);
+  for(n = 0; n < XSKIPLIST_SUMS; n++)
+  {
+    node->weight[n] = weight[n];
+    list->sum[n] += weight[n];
+  }
+
+  for(i = 0; i < level; i++)
+  {
+    node->link[i].next = update[i]->link[i].next;
+    update[i]->link[i].next = node;
+
+    node->link[i].span = update[i]->link[i].span - (rank[0] - rank[i]);
+    update[i]->link[i].span = (rank[0] - rank[i]) + 1;
+
+    /* the weights are split the same way as the span */
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+    {
+      node->link[i].sum[n] = update[i]->link[i].sum[n] 
+                             - (sum[0][n] - sum[i][n]);
+      update[i]->link[i].sum[n] = (sum[0][n] - sum[i][n]) + weight[n];
+    }
+  }
+
+  /* the links above jump over the new node too */
+  for(i = level; i < list->level; i++)
+  {
+    update[i]->link[i].span++;
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+      update[i]->link[i].sum[n] += weight[n];
+  }
+
+  list->count++;
+  return rank[0];
+}
+
+int xskiplist_build(xskiplist_t *list, const unsigned int *ids, 
+                    unsigned int count)
+{
+  xsknode_t *last[XSKIPLIST_MAX_LEVEL];
+  unsigned int last_rank[XSKIPLIST_MAX_LEVEL];
+  unsigned long long last_sum[XSKIPLIST_MAX_LEVEL][XSKIPLIST_SUMS];
+  unsigned int k = 0;
+  int i = 0, n = 0, ret = 0;
+
+  xskiplist_flush(list);
+  for(i = 0; i < XSKIPLIST_MAX_LEVEL; i++)
+  {
+    last[i] = list->head;
+    last_rank[i] = 0;
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+      last_sum[i][n] = 0;
+  }
+
+  /* every node is linked after the last one as high as it */
+  for(k = 0; k < count; k++)
+  {
+    unsigned int weight[XSKIPLIST_SUMS] = {0};
+    unsigned int level = xskiplist_random_level(list);
+    xsknode_t *node = xsknode_create(level, ids[k]);
+
+    if(!node)
+    {
+      ret = -1;
+      break;
+    }
+
+    list->bytes += sizeof(xsknode_t) + level * sizeof(xsklink_t);
+    if(level > list->level)
+      list->level = level;
+
+    if(list->weigh)
+      list->weigh(list->ctx, ids[k], weight);
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+    {
+      node->weight[n] = weight[n];
+      list->sum[n] += weight[n];
+    }
+    list->count++;
+
+    for(i = 0; i < level; i++)
+    {
+      last[i]->link[i].next = node;
+      last[i]->link[i].span = list->count - last_rank[i];
+      for(n = 0; n < XSKIPLIST_SUMS; n++)
+      {
+        last[i]->link[i].sum[n] = list->sum[n] - last_sum[i][n];
+        last_sum[i][n] = list->sum[n];
+      }
+      last[i] = node;
+      last_rank[i] = list->count;
+    }
+  }
+
+  /* the last links of each level run to the end */
+  for(i = 0; i < list->level; i++)
+  {
+    last[i]->link[i].span = list->count - last_rank[i];
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+      last[i]->link[i].sum[n] = list->sum[n] - last_sum[i][n];
+  }
+
+  return ret;
+}
+
+int xskiplist_remove(xskiplist_t *list, unsigned int id)
+{
+  xsknode_t *update[XSKIPLIST_MAX_LEVEL];
+  xsknode_t *node = list->head;
+  int i = 0, n = 0;
+
+  for(i = list->level - 1; i >= 0; i--)
+  {
+    while(node->link[i].next
+          && list->cmp(list->ctx, node->link[i].next->id, id) < 0)
+      node = node->link[i].next;
+    update[i] = node;
+  }
+
+  node = node->link[0].next;
+  if(!node || node->id != id)
+    return -1;
+
+  for(i = 0; i < list->level; i++)
+  {
+    xsklink_t *link = &update[i]->link[i];
+
+    if(link->next == node)
+    {
+      link->span += node->link[i].span - 1;
+      link->next = node->link[i].next;
+      for(n = 0; n < XSKIPLIST_SUMS; n++)
+        link->sum[n] += node->link[i].sum[n] - node->weight[n];
+    }
+    else
+    {
+      link->span--;
+      for(n = 0; n < XSKIPLIST_SUMS; n++)
+        link->sum[n] -= node->weight[n];
+    }
+  }
+
+  for(n = 0; n < XSKIPLIST_SUMS; n++)
+    list->sum[n] -= node->weight[n];
+
+  while(list->level > 1 && !list->head->link[list->level - 1].next)
+    list->level--;
+
+  list->count--;
+  list->bytes -= sizeof(xsknode_t) + node->level * sizeof(xsklink_t);
+  free(node);
+
+  return 0;
+}
+
+xsknode_t *xskiplist_at(xskiplist_t *list, unsigned long rank)
+{
+  xsknode_t *node = list->head;
+  unsigned long traversed = 0;
+  int i = 0;
+
+  if(rank >= list->count)
+    return NULL;
+
+  /* spans count the target itself, so look for rank + 1 */
+  rank++;
+  for(i = list->level - 1; i >= 0; i--)
+  {
+    while(node->link[i].next && traversed + node->link[i].span <= rank)
+    {
+      traversed += node->link[i].span;
+      node = node->link[i].next;
+    }
+
+    if(traversed == rank)
+      return node;
+  }
+
+  return NULL;
+}
+
+long xskiplist_rank(xskiplist_t *list, unsigned int id)
+{
+  xsknode_t *node = list->head;
+  unsigned long traversed = 0;
+  int i = 0;
+
+  for(i = list->level - 1; i >= 0; i--)
+  {
+    while(node->link[i].next
+          && list->cmp(list->ctx, node->link[i].next->id, id) <= 0)
+    {
+      traversed += node->link[i].span;
+      node = node->link[i].next;
+    }
+
+    if(node != list->head && node->id == id)
+      return traversed - 1;
+  }
+
+  return -1;
+}
+
+long xskiplist_search(xskiplist_t *list, xskiplist_pred_f before, 
+                      const void *key)
+{
+  xsknode_t *node = list->head;
+  unsigned long traversed = 0;
+  int i = 0;
+
+  for(i = list->level - 1; i >= 0; i--)
+  {
+    while(node->link[i].next && before(list->ctx, node->link[i].next->id, key))
+    {
+      traversed += node->link[i].span;
+      node = node->link[i].next;
+    }
+  }
+
+  return traversed;
+}
+
+void xskiplist_weigh(xskiplist_t *list, xskiplist_weigh_f weigh)
+{
+  xsknode_t *last[XSKIPLIST_MAX_LEVEL];
+  unsigned long long last_sum[XSKIPLIST_MAX_LEVEL][XSKIPLIST_SUMS];
+  xsknode_t *node = NULL;
+  int i = 0, n = 0;
+
+  list->weigh = weigh;
+  for(n = 0; n < XSKIPLIST_SUMS; n++)
+    list->sum[n] = 0;
+
+  for(i = 0; i < list->level; i++)
+  {
+    last[i] = list->head;
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+      last_sum[i][n] = 0;
+  }
+
+  /* 
+   * one pass: list->sum runs as the prefix sum, a link gets the growth 
+   * since the last node as high as it
+   */
+  for(node = xskiplist_first(list); node; node = xskiplist_next(node))
+  {
+    unsigned int weight[XSKIPLIST_SUMS] = {0};
+
+    if(weigh)
+      weigh(list->ctx, node->id, weight);
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+    {
+      node->weight[n] = weight[n];
+      list->sum[n] += weight[n];
+    }
+
+    for(i = 0; i < node->level; i++)
+    {
+      for(n = 0; n < XSKIPLIST_SUMS; n++)
+      {
+        last[i]->link[i].sum[n] = list->sum[n] - last_sum[i][n];
+        last_sum[i][n] = list->sum[n];
+      }
+      last[i] = node;
+    }
+  }
+
+  for(i = 0; i < list->level; i++)
+    for(n = 0; n < XSKIPLIST_SUMS; n++)
+      last[i]->link[i].sum[n] = list->sum[n] - last_sum[i][n];
+}
+
+unsigned long long xskiplist_sum(xskiplist_t *list, int n, unsigned long rank)
+{
+  xsknode_t *node = list->head;
+  unsigned long traversed = 0;
+  unsigned long long sum = 0;
+  int i = 0;
+
+  assert(n >= 0 && n < XSKIPLIST_SUMS);
+  if(rank >= list->count)
+    return list->sum[n];
+
+  for(i = list->level - 1; i >= 0; i--)
+  {
+    while(node->link[i].next && traversed + node->link[i].span <= rank)
+    {
+      traversed += node->link[i].span;
+      sum += node->link[i].sum[n];
+      node = node->link[i].next;
+    }
+  }
+
+  return sum;
+}
+
+long xskiplist_seek(xskiplist_t *list, int n, unsigned long long sum)
+{
+  xsknode_t *node = list->head;
+  unsigned long traversed = 0;
+  unsigned long long acc = 0;
+  int i = 0;
+
+  assert(n >= 0 && n < XSKIPLIST_SUMS);
+  if(sum >= list->sum[n])
+    return -1;
+
+  /* stop before the node which takes acc past sum */
+  for(i = list->level - 1; i >= 0; i--)
+  {
+    while(node->link[i].next && acc + node->link[i].sum[n] <= sum)
+    {
+      traversed += node->link[i].span;
+      acc += node->link[i].sum[n];
+      node = node->link[i].next;
+    }
+  }
+
+  return traversed;
+}
+
+unsigned int xskiplist_count(xskiplist_t *list)
+{
+  assert(list);
+
+  return list->count;
+}
+
+size_t xskiplist_bytes(xskiplist_t *list)
+{
+  assert(list);
+
+  return list->bytes + sizeof(xsknode_t) 
+         + XSKIPLIST_MAX_LEVEL * sizeof(xsklink_t);
+}
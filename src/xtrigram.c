@@ -0,0 +1,267 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xtrigram.h"
+
+#define XTRIGRAM_INIT_SLOTS 1024
+#define XTRIGRAM_INIT_IDS   4
+
+static inline unsigned int xtrigram_fold(unsigned char c)
+{
+  return c >= 'A' && c <= 'Z' ? c + 'a' - 'A' : c;
+}
+
+static inline unsigned int xtrigram_key(const char *str)
+{
+  return (xtrigram_fold(str[0]) << 16 | xtrigram_fold(str[1]) << 8 
+          | xtrigram_fold(str[2])) + 1;
+}
+
+/* the slot of key or the free one to insert it */
+static xtrigram_list_t *xtrigram_slot(xtrigram_t *tab, unsigned int key)
+{
+  unsigned int i = (key * 2654435761u) & tab->slot_mask;
+
+  while(tab->slots[i].key && tab->slots[i].key != key)
+    i = (i + 1) & tab->slot_mask;
+
+  return &tab->slots[i];
+}
+
+static int xtrigram_alloc(xtrigram_t *tab, unsigned int size)
+{
+  tab->slots = calloc(size, sizeof(xtrigram_list_t));
+  if(!tab->slots)
+  {
+    perror("calloc");
+    return -1;
+  }
+
+  tab->slot_mask = size - 1;
+  tab->used = 0;
+  tab->postings = 0;
+  tab->bytes = size * sizeof(xtrigram_list_t);
+
+  return 0;
+}
+
+xtrigram_t *xtrigram_create(void)
+{
+  xtrigram_t *tab = malloc(sizeof(xtrigram_t));
+  if(!tab)
+  {
+    perror("malloc");
+    return NULL;
+  }
+
+  memset(tab, 0, sizeof(xtrigram_t));
+  if(xtrigram_alloc(tab, XTRIGRAM_INIT_SLOTS) < 0)
+  {
+    free(tab);
+    return NULL;
+  }
+
+  return tab;
+}
+
+static void xtrigram_release(xtrigram_t *tab)
+{
+  unsigned int i = 0;
+
+  for(; i <= tab->slot_mask; i++)
+    free(tab->slots[i].ids);
+
+  free(tab->slots);
+  tab->slots = NULL;
+}
+
+void xtrigram_destroy(xtrigram_t *tab)
+{
+  if(!tab)
+    return;
+
+  xtrigram_release(tab);
+  free(tab);
+}
+
+void xtrigram_flush(xtrigram_t *tab)
+{
+  if(!tab)
+    return;
+
+  xtrigram_release(tab);
+  xtrigram_alloc(tab, XTRIGRAM_INIT_SLOTS);
+}
+
+/* double the slots and rehash, load factor is kept under 1/2 */
+static int xtrigram_grow(xtrigram_t *tab)
+{
+  xtrigram_list_t *old = tab->slots;
+  unsigned int old_size = tab->slot_mask + 1, i = 0;
+  size_t bytes = tab->bytes - old_size * sizeof(xtrigram_list_t);
+
+  tab->slots = calloc(old_size * 2, sizeof(xtrigram_list_t));
+  if(!tab->slots)
+  {
+    perror("calloc");
+    tab->slots = old;
+    return -1;
+  }
+
+  tab->slot_mask = old_size * 2 - 1;
+  tab->bytes = bytes + old_size * 2 * sizeof(xtrigram_list_t);
+
+  for(; i < old_size; i++)
+  {
+    if(old[i].key)
+      *xtrigram_slot(tab, old[i].key) = old[i];
+  }
+
+  free(old);
+  return 0;
+}
+
+static int xtrigram_append(xtrigram_t *tab, xtrigram_list_t *list, 
+                           unsigned int id)
+{
+  /* a trigram seen twice in the same text */
+  if(list->count && list->ids[list->count - 1] == id)
+    return 0;
+
+  if(list->count == list->size)
+  {
+    unsigned int size = list->size ? list->size * 2 : XTRIGRAM_INIT_IDS;
+    unsigned int *ids = realloc(list->ids, size * sizeof(unsigned int));
+    if(!ids)
+    {
+      perror("realloc");
+      return -1;
+    }
+
+    tab->bytes += (size - list->size) * sizeof(unsigned int);
+    list->ids = ids;
+    list->size = size;
+  }
+
+  list->ids[list->count++] = id;
+  tab->postings++;
+  return 0;
+}
+
+int xtrigram_add(xtrigram_t *tab, unsigned int id, const char *text, int len)
+{
+  int i = 0;
+
+  for(; i + 3 <= len; i++)
+  {
+    unsigned int key = xtrigram_key(text + i);
+    xtrigram_list_t *list = xtrigram_slot(tab, key);
+
+    if(!list->key)
+    {
+      if((tab->used + 1) * 2 > tab->slot_mask + 1)
+      {
+        if(xtrigram_grow(tab) < 0)
+          return -1;
+        list = xtrigram_slot(tab, key);
+      }
+
+      list->key = key;
+      tab->used++;
+    }
+
+    if(xtrigram_append(tab, list, id) < 0)
+      return -1;
+  }
+
+  return 0;
+}
+
+long xtrigram_candidates(xtrigram_t *tab, const char *str, int len, 
+                         const unsigned int **ids)
+{
+  xtrigram_list_t *best = NULL;
+  int i = 0;
+
+  *ids = NULL;
+  if(len < 3)
+    return -1;
+
+  for(; i + 3 <= len; i++)
+  {
+    xtrigram_list_t *list = xtrigram_slot(tab, xtrigram_key(str + i));
+
+    /* a trigram nobody has, nothing can match */
+    if(!list->key || !list->count)
+      return 0;
+
+    if(!best || list->count < best->count)
+      best = list;
+  }
+
+  *ids = best->ids;
+  return best->count;
+}
+
+void xtrigram_compact(xtrigram_t *tab, xtrigram_keep_f keep, void *ctx)
+{
+  unsigned int i = 0, j = 0, n = 0;
+
+  for(; i <= tab->slot_mask; i++)
+  {
+    xtrigram_list_t *list = &tab->slots[i];
+
+    if(!list->key)
+      continue;
+
+    for(j = n = 0; j < list->count; j++)
+    {
+      if(keep(ctx, list->ids[j]))
+        list->ids[n++] = list->ids[j];
+    }
+
+    tab->postings -= list->count - n;
+    list->count = n;
+
+    /* give the memory back if most of the list is gone */
+    if(list->size > XTRIGRAM_INIT_IDS && n < list->size / 4)
+    {
+      unsigned int size = n > XTRIGRAM_INIT_IDS ? n : XTRIGRAM_INIT_IDS;
+      unsigned int *ids = realloc(list->ids, size * sizeof(unsigned int));
+
+      if(ids)
+      {
+        tab->bytes -= (list->size - size) * sizeof(unsigned int);
+        list->ids = ids;
+        list->size = size;
+      }
+    }
+  }
+}
+
+size_t xtrigram_bytes(xtrigram_t *tab)
+{
+  return tab->bytes;
+}
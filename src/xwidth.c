@@ -0,0 +1,242 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xwidth.h"
+
+typedef struct
+{
+  unsigned int first;
+  unsigned int last;
+}xwidth_range_t;
+
+/* combining marks, zero width spaces and joiners, variation selectors */
+static const xwidth_range_t xwidth_zero[] =
+{
+  {0x0300, 0x036f}, {0x0483, 0x0489}, {0x0591, 0x05bd}, {0x0610, 0x061a},
+  {0x064b, 0x065f}, {0x0670, 0x0670}, {0x06d6, 0x06dc}, {0x06df, 0x06e4},
+  {0x0816, 0x082d}, {0x0900, 0x0902}, {0x093a, 0x093c}, {0x0941, 0x0948},
+  {0x094d, 0x094d}, {0x0e31, 0x0e31}, {0x0e34, 0x0e3a}, {0x0e47, 0x0e4e},
+  {0x1ab0, 0x1aff}, {0x1dc0, 0x1dff}, {0x200b, 0x200f}, {0x202a, 0x202e},
+  {0x2060, 0x2064}, {0x20d0, 0x20ff}, {0x302a, 0x302d}, {0x3099, 0x309a},
+  {0xfe00, 0xfe0f}, {0xfe20, 0xfe2f}, {0xfeff, 0xfeff}, {0xe0100, 0xe01ef},
+};
+
+/* east asian wide and fullwidth */
+static const xwidth_range_t xwidth_wide[] =
+{
+  {0x1100, 0x115f}, {0x231a, 0x231b}, {0x2329, 0x232a}, {0x23e9, 0x23ec},
+  {0x23f0, 0x23f0}, {0x23f3, 0x23f3}, {0x25fd, 0x25fe}, {0x2614, 0x2615},
+  {0x2648, 0x2653}, {0x267f, 0x267f}, {0x2693, 0x2693}, {0x26a1, 0x26a1},
+  {0x26aa, 0x26ab}, {0x26bd, 0x26be}, {0x26c4, 0x26c5}, {0x26ce, 0x26ce},
+  {0x26d4, 0x26d4}, {0x26ea, 0x26ea}, {0x26f2, 0x26f3}, {0x26f5, 0x26f5},
+  {0x26fa, 0x26fa}, {0x26fd, 0x26fd}, {0x2705, 0x2705}, {0x270a, 0x270b},
+  {0x2728, 0x2728}, {0x274c, 0x274c}, {0x274e, 0x274e}, {0x2753, 0x2755},
+  {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27b0, 0x27b0}, {0x27bf, 0x27bf},
+  {0x2b1b, 0x2b1c}, {0x2b50, 0x2b50}, {0x2b55, 0x2b55}, {0x2e80, 0x303e},
+  {0x3041, 0x3247}, {0x3250, 0x4dbf}, {0x4e00, 0xa4cf}, {0xa960, 0xa97f},
+  {0xac00, 0xd7a3}, {0xf900, 0xfaff}, {0xfe10, 0xfe19}, {0xfe30, 0xfe6f},
+  {0xff00, 0xff60}, {0xffe0, 0xffe6}, {0x16fe0, 0x16fe4}, {0x17000, 0x18cff},
+  {0x1b000, 0x1b2ff}, {0x1f004, 0x1f004}, {0x1f0cf, 0x1f0cf}, 
+  {0x1f18e, 0x1f18e}, {0x1f191, 0x1f19a}, {0x1f200, 0x1f251}, 
+  {0x1f300, 0x1f320}, {0x1f32d, 0x1f335}, {0x1f337, 0x1f37c}, 
+  {0x1f37e, 0x1f393}, {0x1f3a0, 0x1f3ca}, {0x1f3cf, 0x1f3d3}, 
+  {0x1f3e0, 0x1f3f0}, {0x1f3f4, 0x1f3f4}, {0x1f3f8, 0x1f43e}, 
+  {0x1f440, 0x1f440}, {0x1f442, 0x1f4fc}, {0x1f4ff, 0x1f53d}, 
+  {0x1f54b, 0x1f54e}, {0x1f550, 0x1f567}, {0x1f57a, 0x1f57a}, 
+  {0x1f595, 0x1f596}, {0x1f5a4, 0x1f5a4}, {0x1f5fb, 0x1f64f}, 
+  {0x1f680, 0x1f6c5}, {0x1f6cc, 0x1f6cc}, {0x1f6d0, 0x1f6d2}, 
+  {0x1f6d5, 0x1f6d7}, {0x1f6eb, 0x1f6ec}, {0x1f6f4, 0x1f6fc}, 
+  {0x1f7e0, 0x1f7eb}, {0x1f90c, 0x1f93a}, {0x1f93c, 0x1f945}, 
+  {0x1f947, 0x1f9ff}, {0x1fa70, 0x1faff}, {0x20000, 0x2fffd}, 
+  {0x30000, 0x3fffd},
+};
+
+static int xwidth_in(const xwidth_range_t *ranges, int count, unsigned int cp)
+{
+  int low = 0, high = count - 1;
+
+  if(cp < ranges[0].first || cp > ranges[high].last)
+    return 0;
+
+  while(low <= high)
+  {
+    int mid = (low + high) / 2;
+
+    if(cp > ranges[mid].last)
+      low = mid + 1;
+    else if(cp < ranges[mid].first)
+      high = mid - 1;
+    else
+      return 1;
+  }
+
+  return 0;
+}
+
+int xwidth_char(unsigned int cp)
+{
+  if(cp < 0x300)
+    return 1;
+
+  if(xwidth_in(xwidth_zero, sizeof(xwidth_zero) / sizeof(xwidth_zero[0]), cp))
+    return 0;
+
+  if(xwidth_in(xwidth_wide, sizeof(xwidth_wide) / sizeof(xwidth_wide[0]), cp))
+    return 2;
+
+  return 1;
+}
+
+#define XWIDTH_HIGH 0x8080808080808080ULL
+
+size_t xwidth_ascii(const char *str, size_t len)
+{
+  size_t i = 0;
+
+  /* a word with no high bit set is 8 ascii bytes */
+  for(; i + 8 <= len; i += 8)
+  {
+    unsigned long long word;
+
+    memcpy(&word, str + i, sizeof(word));
+    if(word & XWIDTH_HIGH)
+      break;
+  }
+
+  for(; i < len && !(str[i] & 0x80); i++)
+    ;
+
+  return i;
+}
+
+int xwidth_next(const char *str, size_t len, int *cols)
+{
+  const unsigned char *s = (const unsigned char *)str;
+  unsigned int cp = 0;
+  int n = 0, i = 0;
+
+  *cols = 1;
+  if(s[0] < 0x80)
+    return 1;
+
+  if(s[0] >= 0xc2 && s[0] <= 0xdf)
+  {
+    n = 2;
+    cp = s[0] & 0x1f;
+  }
+  else if(s[0] >= 0xe0 && s[0] <= 0xef)
+  {
+    n = 3;
+    cp = s[0] & 0x0f;
+  }
+  else if(s[0] >= 0xf0 && s[0] <= 0xf4)
+  {
+    n = 4;
+    cp = s[0] & 0x07;
+  }
+  else
+    return 1;
+
+  if(len < n)
+    return 1;
+
+  for(i = 1; i < n; i++)
+  {
+    if((s[i] & 0xc0) != 0x80)
+      return 1;
+    cp = cp << 6 | (s[i] & 0x3f);
+  }
+
+  /* overlong forms and surrogates are not characters */
+  if((n == 3 && cp < 0x800) || (n == 4 && (cp < 0x10000 || cp > 0x10ffff))
+     || (cp >= 0xd800 && cp <= 0xdfff))
+    return 1;
+
+  *cols = xwidth_char(cp);
+  return n;
+}
+
+size_t xwidth_strn(const char *str, size_t len)
+{
+  size_t cols = 0, i = 0;
+
+  while(i < len)
+  {
+    size_t ascii = xwidth_ascii(str + i, len - i);
+    int w = 0;
+
+    cols += ascii;
+    i += ascii;
+    if(i == len)
+      break;
+
+    i += xwidth_next(str + i, len - i, &w);
+    cols += w;
+  }
+
+  return cols;
+}
+
+size_t xwidth_str(const char *str)
+{
+  return xwidth_strn(str, strlen(str));
+}
+
+size_t xwidth_fit(const char *str, size_t len, size_t cols, size_t *used)
+{
+  size_t w = 0, i = 0;
+
+  while(i < len)
+  {
+    size_t ascii = xwidth_ascii(str + i, len - i);
+    int n = 0, c = 0;
+
+    if(ascii > cols - w)
+      ascii = cols - w;
+    w += ascii;
+    i += ascii;
+    if(i == len || w == cols)
+      break;
+
+    n = xwidth_next(str + i, len - i, &c);
+    if(w + c > cols)
+      break;
+    w += c;
+    i += n;
+  }
+
+  /* marks which combine with the last character stay with it */
+  while(i < len && w == cols)
+  {
+    int c = 0, n = xwidth_next(str + i, len - i, &c);
+    if(c)
+      break;
+    i += n;
+  }
+
+  if(used)
+    *used = w;
+  return i;
+}
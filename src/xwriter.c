@@ -0,0 +1,161 @@
+/*
+ * Fhelper, powered by Eastforest Co., Ltd
+ *
+ * Copyright (C) 2018-2021 Reid Liu  <lli_njupt@163.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "xwriter.h"
+
+int xwriter_init(xwriter_t *writer, int fd, size_t size)
+{
+  memset(writer, 0, sizeof(xwriter_t));
+  writer->fd = fd;
+  writer->size = size ? size : XWRITER_SIZE;
+
+  writer->buf = malloc(writer->size);
+  if(!writer->buf)
+  {
+    perror("malloc");
+    return -1;
+  }
+
+  return 0;
+}
+
+void xwriter_release(xwriter_t *writer)
+{
+  free(writer->buf);
+  writer->buf = NULL;
+  writer->len = writer->size = 0;
+}
+
+int xwriter_flush(xwriter_t *writer)
+{
+  size_t done = 0;
+
+  while(!writer->error && done < writer->len)
+  {
+    ssize_t n = write(writer->fd, writer->buf + done, writer->len - done);
+
+    if(n < 0 && errno == EINTR)
+      continue;
+
+    if(n <= 0)
+      writer->error = 1;
+    else
+      done += n;
+  }
+
+  writer->len = 0;
+  return writer->error ? -1 : 0;
+}
+
+int xwriter_write(xwriter_t *writer, const void *data, size_t len)
+{
+  /* a big one goes straight out after what is buffered */
+  if(len > writer->size - writer->len)
+  {
+    if(xwriter_flush(writer) < 0)
+      return -1;
+
+    if(len >= writer->size)
+    {
+      const char *ptr = data;
+
+      while(!writer->error && len)
+      {
+        ssize_t n = write(writer->fd, ptr, len);
+
+        if(n < 0 && errno == EINTR)
+          continue;
+
+        if(n <= 0)
+          writer->error = 1;
+        else
+        {
+          ptr += n;
+          len -= n;
+        }
+      }
+
+      return writer->error ? -1 : 0;
+    }
+  }
+
+  memcpy(writer->buf + writer->len, data, len);
+  writer->len += len;
+  return 0;
+}
+
+int xwriter_printf(xwriter_t *writer, const char *fmt, ...)
+{
+  va_list args;
+  int len = 0;
+
+  va_start(args, fmt);
+  len = vsnprintf(writer->buf + writer->len, writer->size - writer->len, 
+                  fmt, args);
+  va_end(args);
+
+  if(len < 0)
+    return -1;
+
+  if(len < writer->size - writer->len)
+  {
+    writer->len += len;
+    return 0;
+  }
+
+  /* it did not fit, once more after a flush or through a bigger buffer */
+  if(xwriter_flush(writer) < 0)
+    return -1;
+
+  if(len < writer->size)
+  {
+    va_start(args, fmt);
+    vsnprintf(writer->buf, writer->size, fmt, args);
+    va_end(args);
+    writer->len = len;
+    return 0;
+  }
+  else
+  {
+    char *buf = malloc(len + 1);
+    int ret = -1;
+
+    if(!buf)
+    {
+      perror("malloc");
+      return -1;
+    }
+
+    va_start(args, fmt);
+    vsnprintf(buf, len + 1, fmt, args);
+    va_end(args);
+    ret = xwriter_write(writer, buf, len);
+    free(buf);
+    return ret;
+  }
+}